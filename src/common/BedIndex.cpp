@@ -0,0 +1,60 @@
+/* Copyright(c)  Ryuichiro Nakato <rnakato@iqb.u-tokyo.ac.jp>
+ * All rights reserved.
+ */
+#include <algorithm>
+#include "BedIndex.hpp"
+#include "extendBedFormat.hpp"
+
+const std::vector<BedIndex::Interval> BedIndex::empty;
+
+BedIndex::BedIndex(const std::string &filename)
+{
+  for (auto &x: parseBed_Hash<bed>(filename)) {
+    std::vector<Interval> v;
+    for (auto &b: x.second) {
+      if (b.start < b.end) v.emplace_back(b.start, b.end);
+    }
+    std::sort(v.begin(), v.end());
+
+    // merge overlapping and adjacent intervals
+    std::vector<Interval> merged;
+    for (auto &b: v) {
+      if (!merged.empty() && b.start <= merged.back().end) merged.back().end = std::max(merged.back().end, b.end);
+      else merged.emplace_back(b);
+    }
+    merged.shrink_to_fit();
+    mp[x.first] = merged;
+  }
+}
+
+size_t BedIndex::size() const
+{
+  size_t n(0);
+  for (auto &x: mp) n += x.second.size();
+  return n;
+}
+
+uint64_t BedIndex::getlen() const
+{
+  uint64_t len(0);
+  for (auto &x: mp) {
+    for (auto &b: x.second) len += b.end - b.start;
+  }
+  return len;
+}
+
+const std::vector<BedIndex::Interval> & BedIndex::getIntervals(const std::string &chr) const
+{
+  auto itr = mp.find(rmchr(chr));
+  if (itr == mp.end()) return empty;
+  return itr->second;
+}
+
+bool BedIndex::contains(const std::vector<Interval> &v, const int64_t pos)
+{
+  // the last interval starting at or before pos
+  auto itr = std::upper_bound(v.begin(), v.end(), Interval(pos, pos));
+  if (itr == v.begin()) return false;
+  --itr;
+  return pos < itr->end;
+}
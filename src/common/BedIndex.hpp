@@ -0,0 +1,42 @@
+/* Copyright(c)  Ryuichiro Nakato <rnakato@iqb.u-tokyo.ac.jp>
+ * All rights reserved.
+ */
+#ifndef _BEDINDEX_HPP_
+#define _BEDINDEX_HPP_
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+/* Sorted and merged intervals of a BED file for each chromosome,
+ * for O(log n) lookup of genomic positions. Intervals are half-open [start, end). */
+class BedIndex {
+public:
+  class Interval {
+  public:
+    int64_t start;
+    int64_t end;
+    Interval(const int64_t s, const int64_t e): start(s), end(e) {}
+    bool operator<(const Interval &x) const { return start < x.start; }
+  };
+
+private:
+  std::unordered_map<std::string, std::vector<Interval>> mp;
+  static const std::vector<Interval> empty;
+
+public:
+  BedIndex() {}
+  explicit BedIndex(const std::string &filename);
+
+  bool isEmpty() const { return mp.empty(); }
+  size_t size() const;
+  uint64_t getlen() const;
+
+  const std::vector<Interval> & getIntervals(const std::string &chr) const;
+  bool contains(const std::string &chr, const int64_t pos) const {
+    return contains(getIntervals(chr), pos);
+  }
+  static bool contains(const std::vector<Interval> &v, const int64_t pos);
+};
+
+#endif /* _BEDINDEX_HPP_ */
@@ -0,0 +1,304 @@
+/* Copyright(c)  Ryuichiro Nakato <rnakato@iqb.u-tokyo.ac.jp>
+ * All rights reserved.
+ */
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+#include <zlib.h>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include "BigWigReader.hpp"
+#include "../submodules/SSP/common/inline.hpp"
+
+namespace {
+  enum : uint32_t {BIGWIG_MAGIC=0x888FFC26, CHROMTREE_MAGIC=0x78CA8C91, RTREE_MAGIC=0x2468ACE0};
+  enum {CHROMTREE_HEADER=32, RTREE_HEADER=48, SECTION_HEADER=24, ZOOM_RECORD=32, BLOCKS_PER_THREAD=16};
+  enum {SECTION_BEDGRAPH=1, SECTION_VARIABLESTEP=2, SECTION_FIXEDSTEP=3};
+
+  template <class T>
+  T readValue(std::ifstream &in)
+  {
+    T val;
+    in.read(reinterpret_cast<char *>(&val), sizeof(T));
+    return val;
+  }
+
+  template <class T>
+  T getValue(const char *&p)
+  {
+    T val;
+    memcpy(&val, p, sizeof(T));
+    p += sizeof(T);
+    return val;
+  }
+
+  std::vector<char> decompressBlock(const std::vector<char> &buf, const uint32_t uncompressBufSize)
+  {
+    if (!uncompressBufSize) return buf;
+
+    std::vector<char> data(uncompressBufSize);
+    uLongf len(uncompressBufSize);
+    int32_t ret(uncompress(reinterpret_cast<Bytef *>(data.data()), &len,
+                           reinterpret_cast<const Bytef *>(buf.data()), buf.size()));
+    if (ret != Z_OK) PRINTERR_AND_EXIT("Error: invalid compressed data block in bigWig (zlib error " << ret << ").");
+    data.resize(len);
+    return data;
+  }
+
+  void parseBlock(const std::vector<char> &data, std::vector<BigWigReader::Interval> &v, const uint32_t chromId)
+  {
+    const char *p(data.data());
+    const char *end(p + data.size());
+    while (p + SECTION_HEADER <= end) {
+      uint32_t id(getValue<uint32_t>(p));
+      uint32_t chromStart(getValue<uint32_t>(p));
+      getValue<uint32_t>(p);  // chromEnd
+      uint32_t itemStep(getValue<uint32_t>(p));
+      uint32_t itemSpan(getValue<uint32_t>(p));
+      uint8_t type(getValue<uint8_t>(p));
+      getValue<uint8_t>(p);   // reserved
+      uint16_t itemCount(getValue<uint16_t>(p));
+
+      size_t itemsize(type == SECTION_BEDGRAPH ? 12 : type == SECTION_VARIABLESTEP ? 8 : 4);
+      if (type < SECTION_BEDGRAPH || type > SECTION_FIXEDSTEP || p + itemCount * itemsize > end)
+        PRINTERR_AND_EXIT("Error: invalid data section in bigWig.");
+      if (id != chromId) {
+        p += itemCount * itemsize;
+        continue;
+      }
+
+      for (uint16_t i=0; i<itemCount; ++i) {
+        int64_t s, e;
+        if (type == SECTION_BEDGRAPH) {
+          s = getValue<uint32_t>(p);
+          e = getValue<uint32_t>(p);
+        } else if (type == SECTION_VARIABLESTEP) {
+          s = getValue<uint32_t>(p);
+          e = s + itemSpan;
+        } else {
+          s = chromStart + static_cast<int64_t>(i) * itemStep;
+          e = s + itemSpan;
+        }
+        v.emplace_back(s, e, getValue<float>(p));
+      }
+    }
+  }
+
+  void parseZoomBlock(const std::vector<char> &data, std::vector<BigWigReader::ZoomRecord> &v, const uint32_t chromId)
+  {
+    const char *p(data.data());
+    const char *end(p + data.size());
+    while (p + ZOOM_RECORD <= end) {
+      uint32_t id(getValue<uint32_t>(p));
+      uint32_t start(getValue<uint32_t>(p));
+      uint32_t e(getValue<uint32_t>(p));
+      uint32_t validCount(getValue<uint32_t>(p));
+      getValue<float>(p);  // minVal
+      getValue<float>(p);  // maxVal
+      float sum(getValue<float>(p));
+      getValue<float>(p);  // sumSquares
+      if (id == chromId && validCount) v.emplace_back(start, e, validCount, sum);
+    }
+  }
+
+  template <class T>
+  void decodeBlocks(const std::vector<std::vector<char>> &vbuf, std::vector<std::vector<T>> &vdata,
+                    void (*parse)(const std::vector<char> &, std::vector<T> &, const uint32_t),
+                    const uint32_t chromId, const uint32_t uncompressBufSize,
+                    const int32_t first, const int32_t nthreads)
+  {
+    for (size_t i=first; i<vbuf.size(); i+=nthreads) {
+      parse(decompressBlock(vbuf[i], uncompressBufSize), vdata[i], chromId);
+    }
+  }
+}
+
+BigWigReader::BigWigReader(const std::string &file):
+  filename(file), chromTreeOffset(0), fullIndexOffset(0), uncompressBufSize(0)
+{
+  std::ifstream in(filename, std::ios::binary);
+  if (!in) PRINTERR_AND_EXIT("cannot open " << filename);
+  readHeader(in);
+  readChromTree(in);
+}
+
+void BigWigReader::readHeader(std::ifstream &in)
+{
+  uint32_t magic(readValue<uint32_t>(in));
+  if (magic != BIGWIG_MAGIC) PRINTERR_AND_EXIT("Error: " << filename << " is not a little-endian bigWig file.");
+
+  readValue<uint16_t>(in);  // version
+  uint16_t zoomLevels(readValue<uint16_t>(in));
+  chromTreeOffset = readValue<uint64_t>(in);
+  readValue<uint64_t>(in);  // fullDataOffset
+  fullIndexOffset = readValue<uint64_t>(in);
+  readValue<uint16_t>(in);  // fieldCount
+  readValue<uint16_t>(in);  // definedFieldCount
+  readValue<uint64_t>(in);  // autoSqlOffset
+  readValue<uint64_t>(in);  // totalSummaryOffset
+  uncompressBufSize = readValue<uint32_t>(in);
+  readValue<uint64_t>(in);  // reserved
+
+  for (uint16_t i=0; i<zoomLevels; ++i) {
+    uint32_t reduction(readValue<uint32_t>(in));
+    readValue<uint32_t>(in);  // reserved
+    uint64_t dataOffset(readValue<uint64_t>(in));
+    uint64_t indexOffset(readValue<uint64_t>(in));
+    vzoom.emplace_back(reduction, dataOffset, indexOffset);
+  }
+  if (!in) PRINTERR_AND_EXIT("Error: truncated bigWig header in " << filename << ".");
+}
+
+void BigWigReader::readChromTree(std::ifstream &in)
+{
+  in.seekg(chromTreeOffset);
+  if (readValue<uint32_t>(in) != CHROMTREE_MAGIC) PRINTERR_AND_EXIT("Error: invalid chromosome tree in " << filename << ".");
+  readValue<uint32_t>(in);  // blockSize
+  uint32_t keySize(readValue<uint32_t>(in));
+  readChromTreeNode(in, chromTreeOffset + CHROMTREE_HEADER, keySize);
+}
+
+void BigWigReader::readChromTreeNode(std::ifstream &in, const uint64_t offset, const uint32_t keySize)
+{
+  in.seekg(offset);
+  uint8_t isLeaf(readValue<uint8_t>(in));
+  readValue<uint8_t>(in);  // reserved
+  uint16_t count(readValue<uint16_t>(in));
+
+  std::vector<char> key(keySize);
+  std::vector<uint64_t> vchild;
+  for (uint16_t i=0; i<count; ++i) {
+    in.read(key.data(), keySize);
+    if (isLeaf) {
+      std::string name(key.data(), strnlen(key.data(), keySize));
+      uint32_t id(readValue<uint32_t>(in));
+      uint32_t size(readValue<uint32_t>(in));
+      chroms[name] = Chrom(id, size);
+    } else {
+      vchild.emplace_back(readValue<uint64_t>(in));
+    }
+  }
+  if (!in) PRINTERR_AND_EXIT("Error: truncated chromosome tree in " << filename << ".");
+  for (auto x: vchild) readChromTreeNode(in, x, keySize);
+}
+
+void BigWigReader::findBlocks(std::ifstream &in, std::vector<Block> &vblock, const uint64_t offset,
+                              const uint32_t chromId, const uint32_t start, const uint32_t end) const
+{
+  in.seekg(offset);
+  uint8_t isLeaf(readValue<uint8_t>(in));
+  readValue<uint8_t>(in);  // reserved
+  uint16_t count(readValue<uint16_t>(in));
+
+  auto qstart = std::make_pair(chromId, start);
+  auto qend   = std::make_pair(chromId, end);
+  std::vector<uint64_t> vchild;
+  for (uint16_t i=0; i<count; ++i) {
+    uint32_t startChromIx(readValue<uint32_t>(in));
+    uint32_t startBase(readValue<uint32_t>(in));
+    uint32_t endChromIx(readValue<uint32_t>(in));
+    uint32_t endBase(readValue<uint32_t>(in));
+    uint64_t dataOffset(readValue<uint64_t>(in));
+    uint64_t dataSize(isLeaf ? readValue<uint64_t>(in) : 0);
+
+    bool overlap(std::make_pair(startChromIx, startBase) < qend && qstart < std::make_pair(endChromIx, endBase));
+    if (!overlap) continue;
+    if (isLeaf) vblock.emplace_back(dataOffset, dataSize);
+    else vchild.emplace_back(dataOffset);
+  }
+  if (!in) PRINTERR_AND_EXIT("Error: truncated R-tree index in " << filename << ".");
+  for (auto x: vchild) findBlocks(in, vblock, x, chromId, start, end);
+}
+
+std::vector<BigWigReader::Block> BigWigReader::getBlocks(const uint64_t indexOffset, const uint32_t chromId,
+                                                        const uint32_t start, const uint32_t end) const
+{
+  std::ifstream in(filename, std::ios::binary);
+  if (!in) PRINTERR_AND_EXIT("cannot open " << filename);
+
+  in.seekg(indexOffset);
+  if (readValue<uint32_t>(in) != RTREE_MAGIC) PRINTERR_AND_EXIT("Error: invalid R-tree index in " << filename << ".");
+
+  std::vector<Block> vblock;
+  findBlocks(in, vblock, indexOffset + RTREE_HEADER, chromId, start, end);
+  std::sort(vblock.begin(), vblock.end());
+  return vblock;
+}
+
+const BigWigReader::Chrom * BigWigReader::getChrom(const std::string &chrname) const
+{
+  for (auto &name: {chrname, "chr" + rmchr(chrname), rmchr(chrname)}) {
+    auto itr = chroms.find(name);
+    if (itr != chroms.end()) return &itr->second;
+  }
+  return nullptr;
+}
+
+template <class T>
+void BigWigReader::readBlocks(const std::vector<Block> &vblock, const uint32_t chromId, const int32_t nthreads,
+                              void (*parse)(const std::vector<char> &, std::vector<T> &, const uint32_t),
+                              const std::function<void(const std::vector<T> &)> &func) const
+{
+  std::ifstream in(filename, std::ios::binary);
+  if (!in) PRINTERR_AND_EXIT("cannot open " << filename);
+
+  // blocks are read sequentially and decoded in parallel, a batch at a time
+  int32_t nthre(std::max(1, nthreads));
+  size_t nbatch(nthre * BLOCKS_PER_THREAD);
+  for (size_t i=0; i<vblock.size(); i+=nbatch) {
+    size_t n(std::min(nbatch, vblock.size() - i));
+    std::vector<std::vector<char>> vbuf(n);
+    for (size_t j=0; j<n; ++j) {
+      vbuf[j].resize(vblock[i+j].size);
+      in.seekg(vblock[i+j].offset);
+      in.read(vbuf[j].data(), vblock[i+j].size);
+    }
+    if (!in) PRINTERR_AND_EXIT("Error: truncated data block in " << filename << ".");
+
+    std::vector<std::vector<T>> vdata(n);
+    if (nthre == 1 || n == 1) {
+      decodeBlocks<T>(vbuf, vdata, parse, chromId, uncompressBufSize, 0, 1);
+    } else {
+      boost::thread_group agroup;
+      for (int32_t t=0; t<nthre; ++t) {
+        agroup.create_thread(boost::bind(decodeBlocks<T>, boost::cref(vbuf), boost::ref(vdata), parse,
+                                         chromId, uncompressBufSize, t, nthre));
+      }
+      agroup.join_all();
+    }
+    for (auto &x: vdata) func(x);
+  }
+}
+
+void BigWigReader::readIntervals(const std::string &chrname, const int32_t nthreads,
+                                 const std::function<void(const std::vector<Interval> &)> &func) const
+{
+  const Chrom *chrom(getChrom(chrname));
+  if (!chrom) return;
+
+  std::vector<Block> vblock(getBlocks(fullIndexOffset, chrom->id, 0, chrom->size));
+  readBlocks<Interval>(vblock, chrom->id, nthreads, parseBlock, func);
+}
+
+uint32_t BigWigReader::getZoomReduction(const int32_t binsize) const
+{
+  uint32_t reduction(0);
+  for (auto &x: vzoom) {
+    if (x.reduction <= static_cast<uint32_t>(binsize)) reduction = std::max(reduction, x.reduction);
+  }
+  return reduction;
+}
+
+void BigWigReader::readZoomRecords(const std::string &chrname, const uint32_t reduction, const int32_t nthreads,
+                                   const std::function<void(const std::vector<ZoomRecord> &)> &func) const
+{
+  const Chrom *chrom(getChrom(chrname));
+  if (!chrom) return;
+
+  for (auto &x: vzoom) {
+    if (x.reduction != reduction) continue;
+    std::vector<Block> vblock(getBlocks(x.indexOffset, chrom->id, 0, chrom->size));
+    readBlocks<ZoomRecord>(vblock, chrom->id, nthreads, parseZoomBlock, func);
+    return;
+  }
+}
@@ -0,0 +1,98 @@
+/* Copyright(c)  Ryuichiro Nakato <rnakato@iqb.u-tokyo.ac.jp>
+ * All rights reserved.
+ */
+#ifndef _BIGWIGREADER_HPP_
+#define _BIGWIGREADER_HPP_
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <functional>
+#include <unordered_map>
+
+/* Reader of bigWig files (little-endian, as written by the UCSC tools and parse2wig+).
+ * The chromosome B+ tree is read at construction, and the data blocks of a chromosome
+ * are found with the R-tree index and decompressed in parallel. */
+class BigWigReader {
+public:
+  class Interval {
+  public:
+    int64_t start;  // 0-based, half-open
+    int64_t end;
+    double val;
+    Interval(const int64_t s, const int64_t e, const double v): start(s), end(e), val(v) {}
+  };
+
+  /* summary of a zoom level record */
+  class ZoomRecord {
+  public:
+    int64_t start;
+    int64_t end;
+    uint32_t validCount;  // number of bases with data
+    double sum;
+    ZoomRecord(const int64_t s, const int64_t e, const uint32_t n, const double v):
+      start(s), end(e), validCount(n), sum(v) {}
+  };
+
+private:
+  class Block {
+  public:
+    uint64_t offset;
+    uint64_t size;
+    Block(const uint64_t o, const uint64_t s): offset(o), size(s) {}
+    bool operator<(const Block &x) const { return offset < x.offset; }
+  };
+
+  class ZoomLevel {
+  public:
+    uint32_t reduction;
+    uint64_t dataOffset;
+    uint64_t indexOffset;
+    ZoomLevel(const uint32_t r, const uint64_t d, const uint64_t i): reduction(r), dataOffset(d), indexOffset(i) {}
+  };
+
+  class Chrom {
+  public:
+    uint32_t id;
+    uint32_t size;
+    Chrom(): id(0), size(0) {}
+    Chrom(const uint32_t i, const uint32_t s): id(i), size(s) {}
+  };
+
+  std::string filename;
+  uint64_t chromTreeOffset;
+  uint64_t fullIndexOffset;
+  uint32_t uncompressBufSize;
+  std::vector<ZoomLevel> vzoom;
+  std::unordered_map<std::string, Chrom> chroms;
+
+  void readHeader(std::ifstream &in);
+  void readChromTree(std::ifstream &in);
+  void readChromTreeNode(std::ifstream &in, const uint64_t offset, const uint32_t keySize);
+  void findBlocks(std::ifstream &in, std::vector<Block> &vblock, const uint64_t offset,
+                  const uint32_t chromId, const uint32_t start, const uint32_t end) const;
+  std::vector<Block> getBlocks(const uint64_t indexOffset, const uint32_t chromId,
+                               const uint32_t start, const uint32_t end) const;
+  const Chrom * getChrom(const std::string &chrname) const;
+
+  template <class T>
+  void readBlocks(const std::vector<Block> &vblock, const uint32_t chromId, const int32_t nthreads,
+                  void (*parse)(const std::vector<char> &, std::vector<T> &, const uint32_t),
+                  const std::function<void(const std::vector<T> &)> &func) const;
+
+public:
+  explicit BigWigReader(const std::string &file);
+
+  bool hasChrom(const std::string &chrname) const { return getChrom(chrname) != nullptr; }
+
+  /* calls func with the intervals of each data block of chrname in the order of the file */
+  void readIntervals(const std::string &chrname, const int32_t nthreads,
+                     const std::function<void(const std::vector<Interval> &)> &func) const;
+
+  /* the largest zoom reduction not exceeding binsize (0: none) */
+  uint32_t getZoomReduction(const int32_t binsize) const;
+  void readZoomRecords(const std::string &chrname, const uint32_t reduction, const int32_t nthreads,
+                       const std::function<void(const std::vector<ZoomRecord> &)> &func) const;
+};
+
+#endif /* _BIGWIGREADER_HPP_ */
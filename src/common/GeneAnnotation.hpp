@@ -16,10 +16,10 @@ class genedata {
   std::string tid;
   std::string gid;
   std::string chr;
-  int32_t txStart;   // "Transcription start position"
-  int32_t txEnd;     // "Transcription end position"
-  int32_t cdsStart;  // "Coding region start"
-  int32_t cdsEnd;    // "Coding region end"
+  int64_t txStart;   // "Transcription start position"
+  int64_t txEnd;     // "Transcription end position"
+  int64_t cdsStart;  // "Coding region start"
+  int64_t cdsEnd;    // "Coding region end"
   int32_t exonCount; // "Number of exons"
   std::string strand;
   std::vector<range> exon;
@@ -33,7 +33,7 @@ class genedata {
 
   genedata(): txStart(0), txEnd(0), cdsStart(0), cdsEnd(0), exonCount(0) {}
 
-  int32_t length() const { return (txEnd - txStart); }
+  int64_t length() const { return (txEnd - txStart); }
   void printall() const {
     // if(this){
       std::cout << tname << "\t" << gname << "\t" << tid << "\t" << gid << "\t" << chr << "\t" << strand << "\t" << txStart << "\t" << txEnd << "\t" << cdsStart << "\t" << cdsEnd << "\t" << exonCount << "\tgene source: " << gsrc << "\ttranscript source: "<< tsrc << "\tgene biotype: "<< gtype << "\ttranscript biotype: "<< ttype  << "\ttranscript tag: "<< ttag << "\t";
@@ -0,0 +1,168 @@
+/* Copyright(c)  Ryuichiro Nakato <rnakato@iqb.u-tokyo.ac.jp>
+ * All rights reserved.
+ */
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <zlib.h>
+#ifdef HAVE_LIBDEFLATE
+#include <libdeflate.h>
+#endif
+#include "GzipReader.hpp"
+#include "../submodules/SSP/common/inline.hpp"
+
+namespace {
+  std::string readFile(const std::string &filename)
+  {
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) PRINTERR_AND_EXIT("cannot open " << filename);
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+  }
+
+  bool isGzip(const char *p, const size_t size)
+  {
+    return size >= 18 && static_cast<unsigned char>(p[0]) == 0x1f && static_cast<unsigned char>(p[1]) == 0x8b;
+  }
+
+  /* ISIZE of the last member: the exact output size for single-member files under 4 GB */
+  size_t getSizeHint(const std::string &buf)
+  {
+    const unsigned char *p(reinterpret_cast<const unsigned char *>(buf.data() + buf.size() -4));
+    size_t isize(p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24));
+    return std::max(isize, buf.size() *4);
+  }
+
+#ifdef HAVE_LIBDEFLATE
+  std::string decompress(const std::string &buf, const std::string &filename)
+  {
+    std::string out(getSizeHint(buf), '\0');
+    size_t nout(0);
+    size_t pos(0);
+
+    libdeflate_decompressor *d(libdeflate_alloc_decompressor());
+    // trailing data other than gzip members is ignored, as by gzread
+    while (isGzip(buf.data() + pos, buf.size() - pos)) {
+      size_t nin(0), n(0);
+      libdeflate_result ret = libdeflate_gzip_decompress_ex(d, buf.data() + pos, buf.size() - pos,
+                                                            &out[nout], out.size() - nout, &nin, &n);
+      if (ret == LIBDEFLATE_INSUFFICIENT_SPACE) {
+        out.resize(out.size() *2);
+        continue;
+      }
+      if (ret != LIBDEFLATE_SUCCESS) PRINTERR_AND_EXIT("Error: invalid gzip data in " << filename << ".");
+      pos += nin;
+      nout += n;
+    }
+    libdeflate_free_decompressor(d);
+
+    out.resize(nout);
+    return out;
+  }
+#else
+  std::string decompress(const std::string &buf, const std::string &filename)
+  {
+    std::string out(getSizeHint(buf), '\0');
+
+    z_stream strm = {};
+    if (inflateInit2(&strm, 15 + 32) != Z_OK) PRINTERR_AND_EXIT("Error: inflateInit2 failed.");
+    strm.next_in  = reinterpret_cast<Bytef *>(const_cast<char *>(buf.data()));
+    strm.avail_in = buf.size();
+
+    size_t nout(0);
+    while (1) {
+      if (nout == out.size()) out.resize(out.size() *2);
+      strm.next_out  = reinterpret_cast<Bytef *>(&out[nout]);
+      strm.avail_out = out.size() - nout;
+      int32_t ret(inflate(&strm, Z_NO_FLUSH));
+      nout = out.size() - strm.avail_out;
+
+      if (ret == Z_STREAM_END) {
+        // trailing data other than gzip members is ignored, as by gzread
+        if (!isGzip(reinterpret_cast<const char *>(strm.next_in), strm.avail_in)) break;
+        inflateReset(&strm);  // next member
+      } else if (ret == Z_BUF_ERROR && strm.avail_out) {
+        break;  // truncated file: keep the data decoded so far, as gzstream does
+      } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+        PRINTERR_AND_EXIT("Error: invalid gzip data in " << filename << " (zlib error " << ret << ").");
+      }
+    }
+    inflateEnd(&strm);
+
+    out.resize(nout);
+    return out;
+  }
+#endif
+}
+
+std::string readGzipFile(const std::string &filename)
+{
+  std::string buf(readFile(filename));
+  if (!isGzip(buf.data(), buf.size())) return buf;
+  return decompress(buf, filename);
+}
+
+GzipStreamBuf::GzipStreamBuf(const std::string &file):
+  filename(file), in(file, std::ios::binary), inbuf(CHUNKSIZE), outbuf(CHUNKSIZE), strm(), gzip(false), finished(false)
+{
+  if (!in) PRINTERR_AND_EXIT("cannot open " << filename);
+  fillInput();
+  gzip = isGzip(reinterpret_cast<const char *>(strm.next_in), strm.avail_in);
+  if (gzip && inflateInit2(&strm, 15 + 32) != Z_OK) PRINTERR_AND_EXIT("Error: inflateInit2 failed.");
+}
+
+GzipStreamBuf::~GzipStreamBuf()
+{
+  if (gzip) inflateEnd(&strm);
+}
+
+/* appends the next chunk of the file to the input not consumed yet */
+bool GzipStreamBuf::fillInput()
+{
+  if (strm.avail_in) std::copy(strm.next_in, strm.next_in + strm.avail_in, reinterpret_cast<Bytef *>(inbuf.data()));
+  in.read(inbuf.data() + strm.avail_in, inbuf.size() - strm.avail_in);
+  size_t n(in.gcount());
+  strm.next_in = reinterpret_cast<Bytef *>(inbuf.data());
+  strm.avail_in += n;
+  return n > 0;
+}
+
+GzipStreamBuf::int_type GzipStreamBuf::underflow()
+{
+  if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+
+  size_t n(0);
+  while (!n && !finished) {
+    if (!strm.avail_in && !fillInput()) {
+      finished = true;  // truncated file: keep the data decoded so far, as gzstream does
+      break;
+    }
+    if (!gzip) {
+      n = strm.avail_in;
+      std::copy(strm.next_in, strm.next_in + n, outbuf.begin());
+      strm.avail_in = 0;
+      break;
+    }
+
+    strm.next_out  = reinterpret_cast<Bytef *>(outbuf.data());
+    strm.avail_out = outbuf.size();
+    int32_t ret(inflate(&strm, Z_NO_FLUSH));
+    n = outbuf.size() - strm.avail_out;
+
+    if (ret == Z_STREAM_END) {
+      // the header of the next member may be split over the chunks
+      if (strm.avail_in < 18) fillInput();
+      // trailing data other than gzip members is ignored, as by gzread
+      if (isGzip(reinterpret_cast<const char *>(strm.next_in), strm.avail_in)) inflateReset(&strm);
+      else finished = true;
+    } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+      PRINTERR_AND_EXIT("Error: invalid gzip data in " << filename << " (zlib error " << ret << ").");
+    }
+  }
+  if (!n) return traits_type::eof();
+
+  setg(outbuf.data(), outbuf.data(), outbuf.data() + n);
+  return traits_type::to_int_type(*gptr());
+}
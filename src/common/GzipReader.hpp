@@ -0,0 +1,54 @@
+/* Copyright(c)  Ryuichiro Nakato <rnakato@iqb.u-tokyo.ac.jp>
+ * All rights reserved.
+ */
+#ifndef _GZIPREADER_HPP_
+#define _GZIPREADER_HPP_
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <zlib.h>
+
+/* Decompresses a whole gzip file (single or multiple members) into memory in one call.
+ * Uses libdeflate when built with -DUSE_LIBDEFLATE=ON, zlib otherwise.
+ * A file without the gzip magic is returned as it is, as gzstream does.
+ * Only for files of bounded size; use GzipStream for the others. */
+std::string readGzipFile(const std::string &filename);
+
+/* Decompresses a gzip file (single or multiple members) in fixed-size chunks with zlib,
+ * so that the memory does not depend on the file size.
+ * A file without the gzip magic is read as it is. */
+class GzipStreamBuf: public std::streambuf {
+  enum {CHUNKSIZE=1<<18};  // 256 KB
+  std::string filename;
+  std::ifstream in;
+  std::vector<char> inbuf;
+  std::vector<char> outbuf;
+  z_stream strm;
+  bool gzip;
+  bool finished;
+
+  bool fillInput();
+
+public:
+  explicit GzipStreamBuf(const std::string &file);
+  ~GzipStreamBuf();
+
+  /* bytes held by a stream */
+  static size_t getMemorySize() { return 2 * CHUNKSIZE + sizeof(z_stream) + (1<<15); }
+
+protected:
+  int_type underflow();
+};
+
+class GzipStream: public std::istream {
+  GzipStreamBuf sbuf;
+public:
+  explicit GzipStream(const std::string &filename):
+    std::istream(nullptr), sbuf(filename)
+  {
+    rdbuf(&sbuf);
+  }
+};
+
+#endif /* _GZIPREADER_HPP_ */
@@ -9,6 +9,7 @@
 #include "../submodules/SSP/src/Mapfile.hpp"
 
 class bed;
+class ShiftProfileSampling;
 
 class AnnotationSeqStatsGenome {
   uint64_t nread_inbed;
@@ -101,6 +102,7 @@ class SeqStatsGenome : public SeqStatsGenomeSSP {
   double getsizefactor(const int32_t i) const { return annoChr[i].getsizefactor(); }
 
   void strShiftProfile(SSPstats &sspst, const std::string &head, const bool isallchr, const bool isverbose);
+  void strShiftProfileSampling(SSPstats &sspst, ShiftProfileSampling &sampling, const std::string &head, const bool isverbose);
 
 };
 
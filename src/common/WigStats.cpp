@@ -1,6 +1,7 @@
 /* Copyright(c)  Ryuichiro Nakato <rnakato@iqb.u-tokyo.ac.jp>
  * All rights reserved.
  */
+#include <boost/thread.hpp>
 #include "WigStats.hpp"
 
 uint32_t getWigDistThre(const std::vector<uint64_t> &wigDist, const uint64_t sum) {
@@ -21,7 +22,6 @@ void WigStats::setWigStats(const WigArray &wigarray)
 {
   double num95(wigarray.getPercentile(0.95));
   //  double min(wigarray.getMinValue());
-  std::vector<int32_t> ar;
   int32_t wigDistSize(wigDist.size());
 
   //  std::cout << "num95  "<< num95 << "  min   " << min << std::endl;
@@ -31,8 +31,36 @@ void WigStats::setWigStats(const WigArray &wigarray)
     int32_t v(wigarray[i]);
     if (v >= num95 || v < 0) continue;
     if (v < wigDistSize) ++wigDist[v];
-    ar.emplace_back(v);
   }
+}
+
+/* fit on the histogram (wigDist) below the count covering 80% of bins */
+void WigStats::estimateZINB()
+{
+  uint64_t sum(0);
+  for (auto x: wigDist) sum += x;
+  if (!sum) return;
+
+  uint32_t thre(getWigDistThre(wigDist, sum));
+  fitZINB(wigDist, thre, nb_p, nb_n, nb_p0);
+}
+
+namespace {
+  void estimateZINBchr(std::vector<WigStats> &chr, const size_t s, const size_t e)
+  {
+    for (size_t i=s; i<e; ++i) chr[i].estimateZINB();
+  }
+}
+
+void WigStatsGenome::estimateZINB(const int32_t nthreads)
+{
+  size_t nchr(chr.size());
+  size_t nthre(std::max(1, std::min(nthreads, static_cast<int32_t>(nchr))));
+  boost::thread_group agroup;
+  for (size_t i=0; i<nthre; ++i) {
+    agroup.create_thread(boost::bind(estimateZINBchr, boost::ref(chr), nchr*i/nthre, nchr*(i+1)/nthre));
+  }
+  agroup.join_all();
 
-  //  setZINBParam(ar);
+  genome.estimateZINB();
 }
@@ -46,6 +46,8 @@ class WigArray {
   {}
 
   size_t size() const { return array.size(); }
+  /* reuse the allocated memory for another chromosome */
+  void reset(const size_t num) { array.assign(num, 0); }
   double operator[] (const size_t i) const {
     checki(i);
     return rmGeta(array[i]);
@@ -83,44 +85,51 @@ class WigArray {
     return rmGeta(min);
   }
 
-  double getLocalAverage(const int32_t i) const {
-    int32_t length_bin(BINNUM_FOR_LOCALPOISSON);
-    checki(i);
+  double getLocalAverage(const int64_t i) const {
+    int64_t length_bin(BINNUM_FOR_LOCALPOISSON);
     if (i<0) PRINTERR_AND_EXIT("Invalid i for WigArray: " << i << " < 0.");
+    checki(i);
 
     int64_t ave(0);
-    int32_t lenhalf(length_bin/2);
-    int32_t left(std::max(i-lenhalf, 0));
-    int32_t right(std::min(i+lenhalf, (int32_t)array.size()));
-    for (int32_t j=left; j<right; ++j) ave += array[j];
+    int64_t lenhalf(length_bin/2);
+    int64_t left(std::max(i-lenhalf, static_cast<int64_t>(0)));
+    int64_t right(std::min(i+lenhalf, static_cast<int64_t>(array.size())));
+    for (int64_t j=left; j<right; ++j) ave += array[j];
     ave /= right - left;
     return rmGeta(ave);
   }
 
   double getPercentile(double per) const {
-    int32_t v95(MyStatistics::getPercentile(array, per));
+    int64_t v95(MyStatistics::getPercentile(array, per));
     return rmGeta(v95);
   }
 
-  void outputAsWig(FILE *File, const int32_t binsize, const int32_t showzero, const bool isfloat) const {
-    for (size_t i=0; i<array.size(); ++i) {
+  /* offset: the position of the first bin (a part of a split chromosome in parse2wig+)
+     nbin: the number of bins output (0: all) */
+  void outputAsWig(FILE *File, const int32_t binsize, const int32_t showzero, const bool isfloat,
+                   const uint64_t offset=0, size_t nbin=0) const {
+    if (!nbin) nbin = array.size();
+    for (size_t i=0; i<nbin; ++i) {
       if (array[i] || showzero) {
-	if (isfloat) fprintf(File, "%zu\t%.3f\n", i*binsize +1, rmGeta(array[i]));
-	else         fprintf(File, "%zu\t%.0f\n", i*binsize +1, rmGeta(array[i]));
+	if (isfloat) fprintf(File, "%zu\t%.3f\n", offset + i*binsize +1, rmGeta(array[i]));
+	else         fprintf(File, "%zu\t%.0f\n", offset + i*binsize +1, rmGeta(array[i]));
       }
     }
   }
-  void outputAsBedGraph(FILE *File, const int32_t binsize, const std::string &name, const uint64_t chrend, const int32_t showzero, const bool isfloat) {
+  /* chrend is relative to offset. The last bin is omitted when it starts at or after chrend. */
+  void outputAsBedGraph(FILE *File, const int32_t binsize, const std::string &name, const uint64_t chrend, const int32_t showzero, const bool isfloat,
+                        const uint64_t offset=0) {
     for (size_t i=0; i<array.size()-1; ++i) {
       if (array[i] || showzero) {
-	if (isfloat) fprintf(File, "%s\t%zu\t%zu\t%.3f\n", name.c_str(), i*binsize, (i+1) * binsize, rmGeta(array[i]));
-	else         fprintf(File, "%s\t%zu\t%zu\t%.0f\n", name.c_str(), i*binsize, (i+1) * binsize, rmGeta(array[i]));
+	if (isfloat) fprintf(File, "%s\t%zu\t%zu\t%.3f\n", name.c_str(), offset + i*binsize, offset + (i+1) * binsize, rmGeta(array[i]));
+	else         fprintf(File, "%s\t%zu\t%zu\t%.0f\n", name.c_str(), offset + i*binsize, offset + (i+1) * binsize, rmGeta(array[i]));
       }
     }
     size_t i = array.size()-1;
+    if (i*binsize >= chrend) return;
     if (array[i] || showzero) {
-      if (isfloat) fprintf(File, "%s\t%zu\t%lu\t%.3f\n", name.c_str(), i*binsize, (uint64_t)chrend, rmGeta(array[i]));
-      else         fprintf(File, "%s\t%zu\t%lu\t%.0f\n", name.c_str(), i*binsize, (uint64_t)chrend, rmGeta(array[i]));
+      if (isfloat) fprintf(File, "%s\t%zu\t%lu\t%.3f\n", name.c_str(), offset + i*binsize, (uint64_t)(offset + chrend), rmGeta(array[i]));
+      else         fprintf(File, "%s\t%zu\t%lu\t%.0f\n", name.c_str(), offset + i*binsize, (uint64_t)(offset + chrend), rmGeta(array[i]));
     }
   }
   void dump() const {
@@ -135,16 +144,17 @@ class WigStats {
   std::vector<uint64_t> wigDist;
 
  public:
-  int32_t nbin;
+  int64_t nbin;
   int32_t binsize;
-  double nb_p, nb_n;
-  WigStats(const int32_t _nbin=0, const int32_t _binsize=0):
+  double nb_p, nb_n, nb_p0;
+  WigStats(const int64_t _nbin=0, const int32_t _binsize=0):
     wigDist(WIGDISTNUM, 0),
     nbin(_nbin), binsize(_binsize),
-    nb_p(0), nb_n(0)
+    nb_p(0), nb_n(0), nb_p0(0)
   {}
 
   void setWigStats(const WigArray &wigarray);
+  void estimateZINB();
 
   void addWigDist(const WigStats &chr) {
     for (size_t i=0; i<wigDist.size(); ++i) wigDist[i] += chr.wigDist[i];
@@ -161,17 +171,18 @@ class WigStats {
 /*  double getNegativeBinomial(const int32_t i) const {
     return _getNegativeBinomial(i, nb_p, nb_n);
   }
-  double getZINB(const int32_t i) const {
-    if (ave) return _getZINB(i, nb_p, nb_n, nb_p0);
-    else return 0;
-  }
   void printPoispar(std::ofstream &out) const {
     out << boost::format("%1$.3f\t%2$.3f\t") % ave % var;
+  }*/
+  double getZINB(const int32_t i) const {
+    if (nb_n) return _getZINB(i, nb_p, nb_n, nb_p0);
+    else return 0;
   }
   void printZINBpar(std::ofstream &out) const {
-    out << boost::format("%1%\t%2%\t%3%") % nb_p % nb_n % nb_p0;
-  }*/
-  int32_t getnbin() const { return nbin; }
+    out << boost::format("%1$.4f\t%2$.4f\t%3$.4f") % nb_p % nb_n % nb_p0;
+  }
+  int64_t getnbin() const { return nbin; }
+  static uint64_t getDistSize() { return WIGDISTNUM * sizeof(uint64_t); }
   int32_t getWigDistsize() const { return wigDist.size(); }
 
   /*  void setZINBParam(const std::vector<int32_t> &ar) {
@@ -186,14 +197,6 @@ class WigStats {
     //    if (ave) estimateZINB(nb_p, nb_n);
     }*/
 
-  /*  void estimateZINB(const double nb_p_pre, const double nb_n_pre) {
-    uint32_t thre = getWigDistThre(wigDist, nbin);
-    double parray[thre+1];
-    parray[0] = thre;
-    for (uint32_t i=0; i<thre; ++i) parray[i+1] = getpWig(i);
-    iterateZINB(&parray, nb_p_pre, nb_n_pre, nb_p, nb_n, nb_p0);
-    return;
-    }*/
 };
 
 class WigStatsGenome {
@@ -202,12 +205,13 @@ class WigStatsGenome {
   WigType type;
   bool outputzero;
   bool onlyreadregion;
+  bool bpres;
 
 public:
   std::vector<WigStats> chr;
   WigStats genome;
 
-  WigStatsGenome(): binsize(0), rcenter(0), type(WigType::NONE), outputzero(false), onlyreadregion(false) {}
+  WigStatsGenome(): binsize(0), rcenter(0), type(WigType::NONE), outputzero(false), onlyreadregion(false), bpres(false) {}
 
   void setOpts(MyOpt::Opts &allopts) {
     MyOpt::Opts opt("Wigarray", 100);
@@ -223,6 +227,7 @@ public:
        boost::program_options::value<int32_t>()->default_value(0)->notifier(boost::bind(&MyOpt::over<int32_t>, _1, 0, "--rcenter")),
        "consider length around the center of fragment")
       ("onlyreadregion", "(for paired-end) count only read region (default: full fragment length)")
+      ("bpres", "output base-pair resolution data as run-length merged bedGraph/bigWig (--binsize is used only for the statistics)")
       ;
     allopts.add(opt);
   }
@@ -232,6 +237,9 @@ public:
     type    = static_cast<WigType>(MyOpt::getVal<int32_t>(values, "outputformat"));
     outputzero = values.count("outputzero");
     onlyreadregion = values.count("onlyreadregion");
+    bpres = values.count("bpres");
+    if (bpres && (type==WigType::COMPRESSWIG || type==WigType::UNCOMPRESSWIG))
+      PRINTERR_AND_EXIT("--bpres supports only bedGraph and bigWig (--outputformat 2 or 3).");
 
     for (auto &x: _chr) chr.emplace_back(x.getlen()/binsize +1);
     for (auto &x: chr) genome.nbin += x.getnbin();
@@ -240,6 +248,7 @@ public:
     std::vector<std::string> strType = {"COMPRESSED WIG", "WIG", "BEDGRAPH", "BIGWIG"};
     std::cout << "Output format: " << strType[static_cast<int32_t>(type)] << std::endl;
     std::cout << "Binsize: " << binsize << " bp" << std::endl;
+    if (bpres) std::cout << "Output in base-pair resolution" << std::endl;
   }
 
   int32_t getbinsize() const { return binsize; }
@@ -247,15 +256,17 @@ public:
   int32_t getrcenter() const { return rcenter; }
   bool isoutputzero() const { return outputzero; }
   bool isonlyreadregion() const { return onlyreadregion; }
+  bool isbpres() const { return bpres; }
   WigType getWigType() const { return type; }
 
+  /* removes a chromosome (e.g., spike-in) from the genome-wide bin number */
+  void excludeChr(const int32_t id) { genome.nbin -= chr[id].getnbin(); }
+
   void setWigStats(const int32_t id, const WigArray &array) {
     chr[id].setWigStats(array);
     genome.addWigDist(chr[id]);
   }
-  /*  void estimateZINB(const int32_t id) {
-    genome.estimateZINB(chr[id].nb_p, chr[id].nb_n);
-   }*/
+  void estimateZINB(const int32_t nthreads);
 };
 
 #endif /* _WIGSTATS_HPP_ */
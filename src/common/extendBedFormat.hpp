@@ -15,18 +15,24 @@
 #include "../../submodules/SSP/common/inline.hpp"
 #include "../../submodules/SSP/common/util.hpp"
 
+/* my_overlap() for 64-bit coordinates (chromosomes longer than 2^31 bp) */
+inline bool isOverlap(const int64_t s1, const int64_t e1, const int64_t s2, const int64_t e2)
+{
+  return !(e1 < s2 || e2 < s1);
+}
+
 class bed {
 public:
   std::string chr;
-  int32_t start;
-  int32_t end;
-  int32_t summit;
+  int64_t start;
+  int64_t end;
+  int64_t summit;
   std::string name;
 
   bed(): start(0), end(0), summit(0), name("") {}
   virtual ~bed(){}
 
-  bed(const std::string &c, const int32_t s, const int32_t e, const int32_t _summit=0):
+  bed(const std::string &c, const int64_t s, const int64_t e, const int64_t _summit=0):
     chr(rmchr(c)), start(s), end(e)
   {
     if (_summit) summit = _summit;
@@ -41,8 +47,8 @@ public:
 
     try {
       chr = rmchr(s[0]);
-      start = stoi(s[1]);
-      end = stoi(s[2]);
+      start = stoll(s[1]);
+      end = stoll(s[2]);
       summit = (start + end)/2;
 //      if(s.size() >= 4) name = s[3];
     } catch (std::exception &e) {
@@ -52,7 +58,7 @@ public:
   }
   void print() const { std::cout << "chr" << chr << "\t" << start  << "\t" << end ; }
   void printHead() const { std::cout << "chromosome\tstart\tend"; }
-  int32_t length() const { return abs(end - start); }
+  int64_t length() const { return std::abs(end - start); }
   std::string getSiteStr() const {
     return "chr" + chr + "-" + std::to_string(start) + "-" + std::to_string(end);
   }
@@ -68,11 +74,11 @@ public:
 class GenomicPosition {
 public:
   std::string chr;
-  int32_t start;
+  int64_t start;
 
   GenomicPosition(): start(0) {}
   GenomicPosition(const std::string &c, const std::string &s):
-    chr(rmchr(c)), start(stoi(s))
+    chr(rmchr(c)), start(stoll(s))
   {}
 
   bool operator<(const GenomicPosition &another) const
@@ -113,7 +119,7 @@ public:
 
 class macsxls : public bed {
 public:
-  int32_t len;
+  int64_t len;
   double pileup;
   double p;
   double enrich;
@@ -124,8 +130,8 @@ public:
   explicit macsxls(std::vector<std::string> &s): bed(s) {
 
     try {
-      len    = stoi(s[3]);
-      summit = stoi(s[4]);
+      len    = stoll(s[3]);
+      summit = stoll(s[4]);
       pileup = stod(s[5]);
       p      = stod(s[6]);
       enrich = stod(s[7]);
@@ -154,14 +160,14 @@ public:
 
   Peak(){}
   Peak(const std::string &c, const int32_t _binsize,
-       const int32_t s, const int32_t e,
+       const int64_t s, const int64_t e,
        const double val, const double _p_inter,
        const double val_input=0, const double _p_enr=0):
     bed(c, s, e), binsize(_binsize), pileup(val), pileup_input(val_input),
     p_inter(_p_inter), p_enr(_p_enr)
   {}
 
-  void renew(const int32_t e, const double val, const double _p_inter, const double val_input=0, const double _p_enr=0) {
+  void renew(const int64_t e, const double val, const double _p_inter, const double val_input=0, const double _p_enr=0) {
     end = e;
     pileup += val;
     pileup_input += val_input;
@@ -287,8 +293,8 @@ public:
   peakoverlapped ofirst;
   peakoverlapped osecond;
   Interaction(): val(0) {}
-  Interaction(const std::string &c1, const int32_t s1, const int32_t e1,
-              const std::string &c2, const int32_t s2, const int32_t e2,
+  Interaction(const std::string &c1, const int64_t s1, const int64_t e1,
+              const std::string &c2, const int64_t s2, const int64_t e2,
               const double v=0):
     val(v), first(c1, s1, e1), second(c2, s2, e2)
   {}
@@ -348,15 +354,15 @@ public:
 
   bool isoverlap_asloop(const bed &loop, const std::vector<bed> &bed) const {
     for (auto &b: bed) {
-      if (loop.chr == b.chr && my_overlap(loop.start, loop.end, b.start, b.end)) return true;
+      if (loop.chr == b.chr && isOverlap(loop.start, loop.end, b.start, b.end)) return true;
     }
     return false;
   }
 
   bool isoverlap_asBed(const bed &bed, const std::vector<Interaction> &vinter) const {
     for (auto &x: vinter) {
-      if ((x.first.chr  == bed.chr && my_overlap(x.first.start,  x.first.end,  bed.start, bed.end)) ||
-          (x.second.chr == bed.chr && my_overlap(x.second.start, x.second.end, bed.start, bed.end)))
+      if ((x.first.chr  == bed.chr && isOverlap(x.first.start,  x.first.end,  bed.start, bed.end)) ||
+          (x.second.chr == bed.chr && isOverlap(x.second.start, x.second.end, bed.start, bed.end)))
         return true;
     }
     return false;
@@ -369,8 +375,8 @@ public:
 class cytoband {
 public:
   std::string chr;
-  int32_t start;
-  int32_t end;
+  int64_t start;
+  int64_t end;
   std::string name;
   std::string stain;
   cytoband(): start(0), end(0) {}
@@ -383,8 +389,8 @@ public:
 
     try {
       chr = rmchr(s[0]);
-      start = stoi(s[1]);
-      end = stoi(s[2]);
+      start = stoll(s[1]);
+      end = stoll(s[2]);
       name = s[3];
       stain = s[4];
       //    std::cout << name << "," << stain << "," << start << "," << end << std::endl;
@@ -398,7 +404,7 @@ public:
     std::cout << "chr" << chr << "\t" << start  << "\t" << end
               << "\t" << name << "\t" << stain << std::endl;
   }
-  int32_t getlen() const { return end - start; }
+  int64_t getlen() const { return end - start; }
 };
 
 
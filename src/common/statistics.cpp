@@ -2,6 +2,7 @@
  * All rights reserved.
  */
 #include <iostream>
+#include <algorithm>
 #include <boost/format.hpp>
 #include <gsl/gsl_randist.h>
 #include <gsl/gsl_cdf.h>
@@ -161,6 +162,158 @@ void iterateZINB(void *par, double nb_p_pre, double nb_n_pre, double &nb_p, doub
   return;
 }
 
+namespace {
+  /* histogram of bin counts: hist[k] bins have k reads. Only k < thre is used. */
+  class ZINBHistogram {
+  public:
+    const std::vector<uint64_t> &hist;
+    int32_t thre;
+    double sum;
+    ZINBHistogram(const std::vector<uint64_t> &h, const int32_t t):
+      hist(h), thre(t), sum(0)
+    {
+      for (int32_t k=0; k<thre; ++k) sum += hist[k];
+    }
+  };
+
+  /* the parameters are optimized as (logit p, log n, logit p0) to be unconstrained.
+     p and p0 are kept off 0 and 1 so that log(p) and log(1-p) stay finite when the minimizer saturates them. */
+  void getZINBParam(const gsl_vector *v, double &p, double &n, double &p0)
+  {
+    const double eps(1e-10);
+    p  = std::min(std::max(1/(1 + exp(-gsl_vector_get(v, 0))), eps), 1 - eps);
+    n  = exp(gsl_vector_get(v, 1));
+    p0 = std::min(std::max(1/(1 + exp(-gsl_vector_get(v, 2))), eps), 1 - eps);
+  }
+
+  /* negative log-likelihood per bin of the histogram truncated at thre, and its analytic gradient.
+     The cost depends on the number of distinct counts, not on the number of bins. */
+  void fdf_zinb_hist(const gsl_vector *v, void *params, double *f, gsl_vector *df)
+  {
+    auto &h = *static_cast<ZINBHistogram *>(params);
+    double p, n, p0;
+    getZINBParam(v, p, n, p0);
+
+    double logp(log(p)), logq(log1p(-p));
+    double lgamma_n(gsl_sf_lngamma(n)), psi_n(gsl_sf_psi(n));
+
+    double nll(0), g_p(0), g_n(0), g_p0(0);
+    double S(0), S_p(0), S_n(0), S_p0(0);  // probability of k < thre and its derivatives
+    for (int32_t k=0; k<h.thre; ++k) {
+      double lognb(gsl_sf_lngamma(k+n) - lgamma_n - gsl_sf_lngamma(k+1) + n*logp + (k ? k*logq : 0));
+      double nb(exp(lognb));
+      double dlognb_p(n/p - k/(1-p));
+      double dlognb_n(gsl_sf_psi(k+n) - psi_n + logp);
+
+      double P(0), P_p(0), P_n(0), P_p0(0);
+      if (!k) {
+        P    = p0 + (1-p0) * nb;
+        P_p  = (1-p0) * nb * dlognb_p;
+        P_n  = (1-p0) * nb * dlognb_n;
+        P_p0 = 1 - nb;
+      } else {
+        P    = (1-p0) * nb;
+        P_p  = P * dlognb_p;
+        P_n  = P * dlognb_n;
+        P_p0 = -nb;
+      }
+      S += P; S_p += P_p; S_n += P_n; S_p0 += P_p0;
+
+      if (!h.hist[k]) continue;
+      double w(h.hist[k] / h.sum);
+      if (!k) {
+        nll  -= w * log(P);
+        g_p  -= w * P_p / P;
+        g_n  -= w * P_n / P;
+        g_p0 -= w * P_p0 / P;
+      } else {  // in log scale to avoid underflow
+        nll  -= w * (log1p(-p0) + lognb);
+        g_p  -= w * dlognb_p;
+        g_n  -= w * dlognb_n;
+        g_p0 += w / (1-p0);
+      }
+    }
+    // conditioned on k < thre
+    nll  += log(S);
+    g_p  += S_p / S;
+    g_n  += S_n / S;
+    g_p0 += S_p0 / S;
+
+    if (f) *f = nll;
+    if (df) {
+      gsl_vector_set(df, 0, g_p * p * (1-p));
+      gsl_vector_set(df, 1, g_n * n);
+      gsl_vector_set(df, 2, g_p0 * p0 * (1-p0));
+    }
+  }
+
+  double f_zinb_hist(const gsl_vector *v, void *params)
+  {
+    double f(0);
+    fdf_zinb_hist(v, params, &f, nullptr);
+    return f;
+  }
+
+  void df_zinb_hist(const gsl_vector *v, void *params, gsl_vector *df)
+  {
+    fdf_zinb_hist(v, params, nullptr, df);
+  }
+
+  double logit(const double x) { return log(x/(1-x)); }
+}
+
+/* Maximum likelihood ZINB fit to a histogram of bin counts (BFGS with analytic gradients).
+   The initial values are the method of moments as in the Nelder-Mead version. */
+void fitZINB(const std::vector<uint64_t> &hist, const int32_t thre, double &p, double &n, double &p0)
+{
+  ZINBHistogram h(hist, std::min(thre, static_cast<int32_t>(hist.size())));
+  p = n = p0 = 0;
+  if (!h.sum || h.thre < 2) return;
+
+  double mean(0), var(0);
+  for (int32_t k=0; k<h.thre; ++k) mean += k * hist[k] / h.sum;
+  for (int32_t k=0; k<h.thre; ++k) var += (k - mean) * (k - mean) * hist[k] / h.sum;
+  double p_pre(var ? mean/var : 0.9);
+  if (p_pre >= 1) p_pre = 0.9;
+  if (p_pre <= 0) p_pre = 0.1;
+  double n_pre(mean ? mean * p_pre /(1 - p_pre) : 1);
+
+  size_t ndim(3);
+  gsl_vector *x = gsl_vector_alloc(ndim);
+  gsl_vector_set(x, 0, logit(p_pre));
+  gsl_vector_set(x, 1, log(n_pre));
+  gsl_vector_set(x, 2, logit(0.1)); // p0
+
+  gsl_multimin_function_fdf func;
+  func.n = ndim;
+  func.f = &f_zinb_hist;
+  func.df = &df_zinb_hist;
+  func.fdf = &fdf_zinb_hist;
+  func.params = &h;
+
+  gsl_multimin_fdfminimizer *s = gsl_multimin_fdfminimizer_alloc(gsl_multimin_fdfminimizer_vector_bfgs2, ndim);
+  gsl_multimin_fdfminimizer_set(s, &func, x, 0.1, 0.1);
+
+  size_t iter(0);
+  int32_t status;
+  do {
+    ++iter;
+    status = gsl_multimin_fdfminimizer_iterate(s);
+    if (status) break;
+    status = gsl_multimin_test_gradient(s->gradient, 1e-6);
+  } while (status == GSL_CONTINUE && iter < 200);
+
+#ifdef DEBUG
+  std::cout << boost::format("ZINB fit: %1% iterations, -logL/bin = %2%\n") % iter % s->f;
+#endif
+
+  getZINBParam(s->x, p, n, p0);
+
+  gsl_vector_free(x);
+  gsl_multimin_fdfminimizer_free(s);
+  return;
+}
+
 double f_poisson(const gsl_vector *v, void *params)
 {
   double *par = (double *)params;
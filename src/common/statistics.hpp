@@ -5,6 +5,7 @@
 #define _STATISTICS_HPP_
 
 #include <vector>
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 
@@ -13,26 +14,30 @@ double getBinomial(int32_t k, double p, int32_t n);
 double _getNegativeBinomial(int32_t k, double p, double n);
 double _getZINB(int32_t k, double p, double n, double p0);
 void iterateZINB(void *, double, double, double &, double &, double &);
+void fitZINB(const std::vector<uint64_t> &hist, const int32_t thre, double &p, double &n, double &p0);
 double _getPoisson(int32_t i, double m);
 void iteratePoisson(void *par, double ave_pre, double &ave, double &p0);
 double getlogpZINB(double k, double p, double n);
 
 namespace MyStatistics {
 
+  /* percentile of nonzero values; selection by nth_element (linear time) instead of a full sort */
   template <class T>
-  T getPercentile(const std::vector<T> &array, const double per, int32_t binnum=0)
+  T getPercentile(const std::vector<T> &array, const double per, size_t binnum=0)
   {
     if (!binnum) binnum = array.size();
     std::vector<T> sortarray;
+    sortarray.reserve(binnum);
 
-    for (int32_t i=0; i<binnum; ++i) {
+    for (size_t i=0; i<binnum; ++i) {
       if(array[i]) sortarray.push_back(array[i]);
     }
     if (!sortarray.size()) return 0;
 
-    sort(sortarray.begin(), sortarray.end());
+    auto nth = sortarray.begin() + std::min(static_cast<size_t>(sortarray.size()*per), sortarray.size() -1);
+    std::nth_element(sortarray.begin(), nth, sortarray.end());
 
-    return sortarray[(int32_t)(sortarray.size()*per)];
+    return *nth;
   };
 }
 
@@ -106,8 +106,8 @@ void parseARSOriDB(const std::string& fileName, HashOfGeneDataMap &mp)
     mp[chr][tname].chr     = chr;
     mp[chr][tname].gname   = tname;
     mp[chr][tname].strand  = "";
-    mp[chr][tname].txStart = stoi(v[5]);
-    mp[chr][tname].txEnd   = stoi(v[6]);
+    mp[chr][tname].txStart = stoll(v[5]);
+    mp[chr][tname].txEnd   = stoll(v[6]);
     mp[chr][tname].gtype   = "ARS";
   }
   return;
@@ -133,8 +133,8 @@ void parseTER(const std::string& fileName, HashOfGeneDataMap &mp)
     mp[chr][tname].chr     = chr;
     mp[chr][tname].gname   = tname;
     mp[chr][tname].strand  = "";
-    mp[chr][tname].txStart = stoi(v[2]);
-    mp[chr][tname].txEnd   = stoi(v[3]);
+    mp[chr][tname].txStart = stoll(v[2]);
+    mp[chr][tname].txEnd   = stoll(v[3]);
     mp[chr][tname].gtype   = "TER";
   }
   return;
@@ -184,12 +184,12 @@ HashOfGeneDataMap parseSGD(const std::string& fileName)
     tmp[chr][tname].chr = chr;
     tmp[chr][tname].gtype = type;
     if (v[11] == "C") {
-      tmp[chr][tname].txStart = stoi(v[10]);
-      tmp[chr][tname].txEnd   = stoi(v[9]);
+      tmp[chr][tname].txStart = stoll(v[10]);
+      tmp[chr][tname].txEnd   = stoll(v[9]);
       tmp[chr][tname].strand  = "-";
     } else {
-      tmp[chr][tname].txStart = stoi(v[9]);
-      tmp[chr][tname].txEnd   = stoi(v[10]);
+      tmp[chr][tname].txStart = stoll(v[9]);
+      tmp[chr][tname].txEnd   = stoll(v[10]);
       tmp[chr][tname].strand  = "+";
     }
     if (type == "ARS" || type == "centromere"|| type == "teromere") tmp[chr][tname].strand = "";
@@ -226,10 +226,10 @@ HashOfGeneDataMap parseRefFlat(const std::string& fileName)
       tmp[chr][tname].tname   = tname;
       tmp[chr][tname].chr     = chr;
       tmp[chr][tname].strand  = v[3];
-      tmp[chr][tname].txStart = stoi(v[4]);
-      tmp[chr][tname].txEnd   = stoi(v[5]);
-      tmp[chr][tname].cdsStart = stoi(v[6]);
-      tmp[chr][tname].cdsEnd   = stoi(v[7]);
+      tmp[chr][tname].txStart = stoll(v[4]);
+      tmp[chr][tname].txEnd   = stoll(v[5]);
+      tmp[chr][tname].cdsStart = stoll(v[6]);
+      tmp[chr][tname].cdsEnd   = stoll(v[7]);
       tmp[chr][tname].exonCount = stoi(v[8]);
       if (v.size() >= 13) tmp[chr][tname].gtype = v[12];
       else if (v.size() >= 12) tmp[chr][tname].gtype = v[11];
@@ -242,7 +242,7 @@ HashOfGeneDataMap parseRefFlat(const std::string& fileName)
       boost::split(exonEnds,  v[10], boost::algorithm::is_any_of(","));
 
       for (int32_t i=0; i<tmp[chr][tname].exonCount; i++) {
-        tmp[chr][tname].exon.emplace_back(stoi(exonStarts[i]), stoi(exonEnds[i]));
+        tmp[chr][tname].exon.emplace_back(stoll(exonStarts[i]), stoll(exonEnds[i]));
       }
     } catch (std::exception &e) {
       PRINTERR_AND_EXIT("invalid columns in refFlat format. " + std::string(e.what()));
@@ -273,8 +273,8 @@ HashOfGeneDataMap parseGtf(const std::string& fileName)
     if (feat == "gene" || feat == "transcript" || feat == "three_prime_utr" || feat == "five_prime_utr") continue;
 
     std::string chr(rmchr(v[0]));
-    int32_t start(stoi(v[3]));
-    int32_t end(stoi(v[4]));
+    int64_t start(stoll(v[3]));
+    int64_t end(stoll(v[4]));
     std::string strand(v[6]);
     std::string annotation(v[8]);
 
@@ -401,7 +401,7 @@ std::vector<chrsize> readGenomeTable(const std::string& fileName)
     if (lineStr.empty() || lineStr[0] == '#') continue;
     std::vector<std::string> v;
     boost::split(v, lineStr, boost::algorithm::is_any_of("\t"));
-    gt.emplace_back(v[0], stoi(v[1]));
+    gt.emplace_back(v[0], stoll(v[1]));
   }
   // Greekchr
   /*  for (auto &x: gt) {
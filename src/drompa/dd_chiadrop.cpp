@@ -139,8 +139,8 @@ void PDFPage::strokeChIADropBarcode(const std::vector<int32_t> &v, const std::st
   double ywidth = std::min(_ywidth, 0.4);
   double ycenter(yaxis + ywidth/2);
 
-  int32_t s = std::max(v[0], par.xstart);
-  int32_t e = std::min(v[v.size()-1], par.xend);
+  int64_t s = std::max(static_cast<int64_t>(v[0]), par.xstart);
+  int64_t e = std::min(static_cast<int64_t>(v[v.size()-1]), par.xend);
 
   //  cr->set_source_rgba(CLR_GRAY2, 1);
   cr->set_source_rgba(color.r, color.g, color.b, 0.4);
@@ -85,7 +85,7 @@ namespace {
 
 void GraphData::setValue(const DROMPA::GraphDataFileName &g,
 	      const std::string &chr,
-	      const int32_t chrlen, const std::string &l,
+	      const int64_t chrlen, const std::string &l,
 	      const double ymin, const double ymax)
 {
   binsize = g.getbinsize();
@@ -107,9 +107,9 @@ void GraphData::setValue(const DROMPA::GraphDataFileName &g,
     std::vector<std::string> v;
     boost::split(v, lineStr, boost::algorithm::is_any_of(" \t"), boost::algorithm::token_compress_on);
 
-    int32_t start(stoi(v[0]));
+    int64_t start(stoll(v[0]));
     if(start % binsize){
-      printf("%d %d\n", start, binsize);
+      printf("%ld %d\n", start, binsize);
       PRINTERR_AND_EXIT("[E]graph: invalid start position or binsize:  " << filename);
     }
     double val(stod(v[1]));
@@ -138,7 +138,7 @@ void PDFPage::StrokeWidthOfInteractionSite(const bed &site, const double y)
 }
 
 // cr->arc(中心x, 中心y, 半径, start角度, end角度) 角度はラジアン
-void PDFPage::drawArc_from_to(const Interaction &inter, const int32_t start, const int32_t end, const int32_t ref_height, const double ref_ytop)
+void PDFPage::drawArc_from_to(const Interaction &inter, const int64_t start, const int64_t end, const int32_t ref_height, const double ref_ytop)
 {
   double ytop = ref_ytop + 10;
   int32_t height = ref_height - 20;
@@ -157,7 +157,7 @@ void PDFPage::drawArc_from_to(const Interaction &inter, const int32_t start, con
   StrokeWidthOfInteractionSite(inter.second, ytop);
 }
 
-void PDFPage::drawArc_from_none(const Interaction &inter, const int32_t start, const int32_t end, const int32_t ref_height, const double ref_ytop)
+void PDFPage::drawArc_from_none(const Interaction &inter, const int64_t start, const int64_t end, const int32_t ref_height, const double ref_ytop)
 {
   double ytop = ref_ytop + 10;
   int32_t height = ref_height;
@@ -180,7 +180,7 @@ void PDFPage::drawArc_from_none(const Interaction &inter, const int32_t start, c
   StrokeWidthOfInteractionSite(inter.first, ytop);
 }
 
-void PDFPage::drawArc_none_to(const Interaction &inter, const int32_t start, const int32_t end, const int32_t ref_height, const double ref_ytop)
+void PDFPage::drawArc_none_to(const Interaction &inter, const int64_t start, const int64_t end, const int32_t ref_height, const double ref_ytop)
 {
   double ytop = ref_ytop + 10;
   int32_t height = ref_height;
@@ -233,8 +233,8 @@ void PDFPage::drawInteraction(const InteractionSet &vinter)
 	  cr->set_source_rgba(color.r, color.g, color.b, 0.8);
 	  }*/
 
-    int32_t xcen_head(-1);
-    int32_t xcen_tail(-1);
+    int64_t xcen_head(-1);
+    int64_t xcen_tail(-1);
     if (par.xstart <= x.first.summit  && x.first.summit  <= par.xend) xcen_head = x.first.summit  - par.xstart;
     if (par.xstart <= x.second.summit && x.second.summit <= par.xend) xcen_tail = x.second.summit - par.xstart;
 
@@ -258,7 +258,7 @@ void PDFPage::stroke_xaxis(const double y)
   int32_t interval(interval_large/10);
 
   cr->set_source_rgba(CLR_BLACK, 1);
-  for(int32_t i=setline(par.xstart, interval); i<=par.xend; i+=interval) {
+  for(int64_t i=setline(par.xstart, interval); i<=par.xend; i+=interval) {
 //    std::cout << par.xstart << "\t" << interval << "\t" << par.xend << "\t" << i << std::endl;
 
     double x(BP2PIXEL(i - par.xstart));
@@ -278,8 +278,8 @@ void PDFPage::StrokeGraph(const GraphData &graph)
 {
   DEBUGprint_FUNCStart();
 
-  int32_t s(par.xstart/graph.binsize);
-  int32_t e(par.xend/graph.binsize +1);
+  int64_t s(par.xstart/graph.binsize);
+  int64_t e(par.xend/graph.binsize +1);
   double diff = graph.binsize * par.dot_per_bp;
 
   double ytop(par.yaxis_now);
@@ -292,7 +292,7 @@ void PDFPage::StrokeGraph(const GraphData &graph)
   double xpre(OFFSET_X);
   double xcen(BP2PIXEL(0.5*graph.binsize));
   double ypre(ybottom - graph.getylen(s));
-  for (int32_t i=s; i<e; ++i, xcen += diff) {
+  for (int64_t i=s; i<e; ++i, xcen += diff) {
     double ycen(ybottom - graph.getylen(i));
     strokeGraph4EachWindow(cr, xpre, ypre, xcen, ycen, ybottom + 10);
     xpre = xcen;
@@ -397,7 +397,7 @@ void PDFPage::stroke_xaxis_num(const double y, const int32_t fontsize)
   int32_t interval(setInterval());
 
   cr->set_source_rgba(CLR_BLACK, 1);
-  for(int32_t i=setline(par.xstart, interval); i<=par.xend; i+=interval) {
+  for(int64_t i=setline(par.xstart, interval); i<=par.xend; i+=interval) {
     std::string str;
     double x(BP2PIXEL(i - par.xstart));
     if (par.width_per_line > 100*NUM_1M)     str = float2string(i/static_cast<double>(NUM_1M), 1) + "M";
@@ -623,8 +623,8 @@ void Figure::Draw_SpecificGene(DROMPA::Global &p,
   for (auto &m: gmp_chr) {
     if(!p.drawregion.ExistInGeneLociFile(m.second.gname)) continue;
 
-    int32_t start = std::max(0, m.second.txStart - len);
-    int32_t end   = std::min(m.second.txEnd + len, vReadArray.getchrlen() -1);
+    int64_t start = std::max(static_cast<int64_t>(0), m.second.txStart - len);
+    int64_t end   = std::min(m.second.txEnd + len, vReadArray.getchrlen() -1);
     int32_t num_page(p.drawparam.getNumPage(start, end));
     for(int32_t i=0; i<num_page; ++i) {
       std::cout << boost::format("   page %5d/%5d/%s\r") % (i+1) % num_page % m.second.gname << std::flush;
@@ -15,15 +15,20 @@ class Figure {
 
 public:
   Figure(DROMPA::Global &p, const chrsize &chr):
-    vReadArray(p, chr),
+    Figure(p, vChrArray(p, chr))
+  {}
+  /* with the arrays loaded in advance (forEachChrArray) */
+  Figure(DROMPA::Global &p, vChrArray &&array):
+    vReadArray(std::move(array)),
     vsamplepairoverlayed(p.samplepair),
-    regionBed(p.drawregion.getRegionBedChr(chr.getname()))
+    regionBed(p.drawregion.getRegionBedChr(vReadArray.getchr().getname()))
 //    pagewidth(p.drawparam.width_draw_pixel)
   {
     int32_t normtype(p.getChIPInputNormType());
+    std::string chrname(vReadArray.getchr().getname());
     for (auto &x: vsamplepairoverlayed) {
-      x.first.setScalingFactor(normtype, vReadArray, chr.getname());
-      if (x.OverlayExists()) x.second.setScalingFactor(normtype, vReadArray, chr.getname());
+      x.first.setScalingFactor(normtype, vReadArray, chrname);
+      if (x.OverlayExists()) x.second.setScalingFactor(normtype, vReadArray, chrname);
     }
   }
 
@@ -46,7 +51,7 @@ public:
     return 1;
   }
 
-  void generateWig(const std::string &chrname, const int32_t chrlen) {
+  void generateWig(const std::string &chrname, const int64_t chrlen) {
     DEBUGprint_FUNCStart();
     
     for (auto &x: vsamplepairoverlayed) {
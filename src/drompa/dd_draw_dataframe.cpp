@@ -62,7 +62,7 @@ void DataFrame::StrokeSampleLabel(const SamplePairOverlayed &pair) {
 
 double DataFrame::getmax(const SamplePairEach &pair,
               const vChrArray &vReadArray,
-              const int32_t i, const int32_t thin)
+              const int64_t i, const int32_t thin)
 {
   double value(0);
   double v;
@@ -78,8 +78,8 @@ void DataFrame::StrokeBins(const SamplePairEach &pair,
                            const int32_t nlayer)
 {
   int32_t binsize(pair.getbinsize());
-  int32_t sbin(par.xstart/binsize);
-  int32_t ebin(par.xend/binsize);
+  int64_t sbin(par.xstart/binsize);
+  int64_t ebin(par.xend/binsize);
   double dot_per_bin(binsize * par.dot_per_bp);
   int32_t yaxis(par.yaxis_now);  // convert to int
 
@@ -94,7 +94,7 @@ void DataFrame::StrokeBins(const SamplePairEach &pair,
   if (thin > 1) cr->set_line_width(dot_per_bin*thin);
   else cr->set_line_width(dot_per_bin);
 
-  for (int32_t i=sbin; i<ebin-thin+1; i += thin, xcen += dot_per_bin*thin) {
+  for (int64_t i=sbin; i<ebin-thin+1; i += thin, xcen += dot_per_bin*thin) {
     double value(0);
     if (thin > 1) value = getmax(pair, vReadArray, i, thin);
     else value = getVal(pair, vReadArray, i);
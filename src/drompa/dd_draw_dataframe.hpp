@@ -20,7 +20,7 @@ class DataFrame {
   }
 
   double getmax(const SamplePairEach &pair, const vChrArray &vReadArray,
-                const int32_t i, const int32_t thin);
+                const int64_t i, const int32_t thin);
   void StrokeBins(const SamplePairEach &pair, const vChrArray &vReadArray, const int32_t nlayer);
   virtual void StrokeEachBin(const double value, const double xcen,
                              const int32_t yaxis, const int32_t nlayer);
@@ -77,7 +77,7 @@ protected:
   virtual void getColor1st(const double alpha)=0;
   virtual void getColor2nd(const double alpha)=0;
   virtual void setColor(const double value, const int32_t nlayer, const double alpha);
-  virtual double getVal(const SamplePairEach &pair, const vChrArray &vReadArray, const int32_t i)=0;
+  virtual double getVal(const SamplePairEach &pair, const vChrArray &vReadArray, const int64_t i)=0;
   virtual const std::string getAssayName() const =0;
   virtual double get_yscale_num(int32_t i, double scale) const {
     if (shownegative) return (i - barnum_minus) * scale;
@@ -89,7 +89,7 @@ protected:
 
 
 class ChIPDataFrame : public DataFrame {
-  double getVal(const SamplePairEach &pair, const vChrArray &vReadArray, const int32_t i) {
+  double getVal(const SamplePairEach &pair, const vChrArray &vReadArray, const int64_t i) {
     return vReadArray.getArray(pair.argvChIP).array[i];
   }
 
@@ -113,10 +113,10 @@ class ChIPDataFrame : public DataFrame {
 
   template <class T>
   void strokePeaks(T &bed) {
-    if (!my_overlap(bed.start, bed.end, par.xstart, par.xend)) return;
+    if (!isOverlap(bed.start, bed.end, par.xstart, par.xend)) return;
 
-    int32_t s(std::max(bed.start, par.xstart) - par.xstart);
-    int32_t e(std::min(bed.end, par.xend)     - par.xstart);
+    int64_t s(std::max(bed.start, par.xstart) - par.xstart);
+    int64_t e(std::min(bed.end, par.xend)     - par.xstart);
     double x(BP2PIXEL(s));
     double len((e-s)* par.dot_per_bp);
     /*    DEBUGprint("bed.start " << bed.start << " bed.end "  << bed.end
@@ -147,7 +147,7 @@ class ChIPDataFrame : public DataFrame {
 };
 
 class InputDataFrame : public DataFrame {
-  double getVal(const SamplePairEach &pair, const vChrArray &vReadArray, const int32_t i) {
+  double getVal(const SamplePairEach &pair, const vChrArray &vReadArray, const int64_t i) {
     return vReadArray.getArray(pair.argvInput).array[i];
   }
 
@@ -175,7 +175,7 @@ class RatioDataFrame : public DataFrame {
 
   void setColor(const double value, const int32_t nlayer, const double alpha);
 
-  double getVal(const SamplePairEach &pair, const vChrArray &vReadArray, const int32_t i)
+  double getVal(const SamplePairEach &pair, const vChrArray &vReadArray, const int64_t i)
   {
     return CalcRatio(vReadArray.getArray(pair.argvChIP).array[i],
                      vReadArray.getArray(pair.argvInput).array[i],
@@ -209,7 +209,7 @@ class LogRatioDataFrame : public DataFrame {
   void getColor2nd(const double alpha) { cr->set_source_rgba(CLR_DEEPSKYBLUE, alpha); }
   const std::string getAssayName() const { return "Enrichment"; }
 
-  double getVal(const SamplePairEach &pair, const vChrArray &vReadArray, const int32_t i)
+  double getVal(const SamplePairEach &pair, const vChrArray &vReadArray, const int64_t i)
   {
     return CalcRatio(vReadArray.getArray(pair.argvChIP).array[i],
                      vReadArray.getArray(pair.argvInput).array[i],
@@ -240,7 +240,7 @@ public:
 
 class PvalueDataFrame : public DataFrame {
   void setColor(const double value, const int32_t nlayer, const double alpha);
-  virtual double getVal(const SamplePairEach &pair, const vChrArray &vReadArray, const int32_t i)=0;
+  virtual double getVal(const SamplePairEach &pair, const vChrArray &vReadArray, const int64_t i)=0;
   void getColor1st(const double alpha) { cr->set_source_rgba(CLR_RED, alpha); }
   void getColor2nd(const double alpha) { cr->set_source_rgba(CLR_BLUE, alpha); }
   virtual const std::string getAssayName() const =0;
@@ -263,7 +263,7 @@ public:
 };
 
 class PinterDataFrame : public PvalueDataFrame {
-  double getVal(const SamplePairEach &pair, const vChrArray &vReadArray, const int32_t i) {
+  double getVal(const SamplePairEach &pair, const vChrArray &vReadArray, const int64_t i) {
     const ChrArray &a = vReadArray.getArray(pair.argvChIP);
     double myu(a.array.getLocalAverage(i));
 
@@ -280,7 +280,7 @@ public:
 };
 
 class PenrichDataFrame : public PvalueDataFrame {
-  double getVal(const SamplePairEach &pair, const vChrArray &vReadArray, const int32_t i) {
+  double getVal(const SamplePairEach &pair, const vChrArray &vReadArray, const int64_t i) {
     return getlogp_BinomialTest(vReadArray.getArray(pair.argvChIP).array[i],
                                 vReadArray.getArray(pair.argvInput).array[i],
                                 pair.ratio);
@@ -32,9 +32,9 @@ inline double CalcRatio(const double c, const double i, const double r)
   return i ? c/i*r: 0;
 }
 
-inline int32_t setline(const int32_t start, const int32_t interval)
+inline int64_t setline(const int64_t start, const int32_t interval)
 {
-  int32_t posi(start-1);
+  int64_t posi(start-1);
   if(!posi%interval) return posi;
   else return (posi/interval +1) * interval;
 }
@@ -17,18 +17,18 @@ class RGB;
 
 class DParam {
 public:
-  int32_t pstart;
-  int32_t pend;
+  int64_t pstart;
+  int64_t pend;
 
-  int32_t start;
-  int32_t end;
+  int64_t start;
+  int64_t end;
   int32_t num_line;
   int32_t num_page;
   int32_t width_per_line;
 
   double yaxis_now;
-  int32_t xstart;
-  int32_t xend;
+  int64_t xstart;
+  int64_t xend;
 
   double ystep;
   int32_t barnum;
@@ -39,7 +39,7 @@ public:
 
   double alpha;
 
-  DParam(const int32_t s, const int32_t e, const DROMPA::Global &p):
+  DParam(const int64_t s, const int64_t e, const DROMPA::Global &p):
     pstart(0), pend(0), start(s), end(e),
     num_line(p.drawparam.getNumLine(start, end)),
     num_page(p.drawparam.getNumPage(start, end)),
@@ -76,10 +76,10 @@ public:
   GraphData(): binsize(0), memnum(0), boxheight(0), mmin(0), mmax(0), mwid(0){}
 
   void setValue(const DROMPA::GraphDataFileName &g,
-		const std::string &chr, const int32_t chrlen,
+		const std::string &chr, const int64_t chrlen,
 		const std::string &l,	const double ymin, const double ymax);
 
-  double getylen(const int32_t i) const {
+  double getylen(const int64_t i) const {
     return boxheight * (array[i] - mmin)/mwid;
   }
   double getBoxHeight4mem() const { return boxheight/memnum; }
@@ -133,7 +133,7 @@ class PDFPage {
           const vChrArray &_vReadArray,
           const std::vector<SamplePairOverlayed> &pair,
           const Cairo::RefPtr<Cairo::PdfSurface> surface,
-          const int32_t s, const int32_t e):
+          const int64_t s, const int64_t e):
     vReadArray(_vReadArray),
     chrname(vReadArray.getchr().getrefname()),
     vsamplepairoverlayed(pair),
@@ -162,9 +162,9 @@ class PDFPage {
   void stroke_xaxis(const double y);
   void stroke_xaxis_num(const double y, const int32_t fontsize);
   void StrokeWidthOfInteractionSite(const bed &site, const double y);
-  void drawArc_from_to(const Interaction &inter, const int32_t start, const int32_t end, const int32_t ref_height, const double ref_ytop);
-  void drawArc_from_none(const Interaction &inter, const int32_t start, const int32_t end, const int32_t ref_height, const double ref_ytop);
-  void drawArc_none_to(const Interaction &inter, const int32_t start, const int32_t end, const int32_t ref_height, const double ref_ytop);
+  void drawArc_from_to(const Interaction &inter, const int64_t start, const int64_t end, const int32_t ref_height, const double ref_ytop);
+  void drawArc_from_none(const Interaction &inter, const int64_t start, const int64_t end, const int32_t ref_height, const double ref_ytop);
+  void drawArc_none_to(const Interaction &inter, const int64_t start, const int64_t end, const int32_t ref_height, const double ref_ytop);
 
   std::tuple<int32_t, int32_t> get_start_end_linenum(const int32_t page, const int32_t linenum_per_page) const {
     int32_t start(0), end(0);
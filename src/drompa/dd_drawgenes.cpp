@@ -74,11 +74,11 @@ namespace {
     return;
   }
 
-  std::vector<genedata> get_garray(const GeneDataMap &mp, const int32_t xstart, const int32_t xend)
+  std::vector<genedata> get_garray(const GeneDataMap &mp, const int64_t xstart, const int64_t xend)
   {
     std::vector<genedata> garray;
     for (auto &m: mp) {
-      if (!my_overlap(m.second.txStart, m.second.txEnd, xstart, xend)) continue;
+      if (!isOverlap(m.second.txStart, m.second.txEnd, xstart, xend)) continue;
       if (m.second.gtype == "nonsense_mediated_decay" ||
           m.second.gtype == "processed_transcript" ||
           m.second.gtype == "retained_intron") continue;
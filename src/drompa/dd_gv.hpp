@@ -312,11 +312,11 @@ namespace DROMPA {
     double getystep() const { return ystep; }
     double getHeightDf() const { return ystep * barnum; }
 
-    int32_t getNumLine(const int32_t s, const int32_t e) const{
+    int32_t getNumLine(const int64_t s, const int64_t e) const{
       int32_t nline = (e-s -1) / width_per_line +1;
       return nline;
     }
-    int32_t getNumPage(const int32_t s, const int32_t e) const {
+    int32_t getNumPage(const int64_t s, const int64_t e) const {
       int32_t npage = (getNumLine(s,e) -1) / linenum_per_page +1;
       return npage;
     }
@@ -337,6 +337,8 @@ namespace DROMPA {
     bool includeYM;
     int32_t norm;
     int32_t smoothing;
+    int32_t nthreads;
+    int32_t pipeline_memory;
 
     WigType genwig_oftype;
     int32_t genwig_ofvalue;
@@ -362,7 +364,7 @@ namespace DROMPA {
 
     Global():
       ispng(false), showchr(false), iftype(WigType::NONE),
-      oprefix(""), includeYM(false), norm(0), smoothing(0),
+      oprefix(""), includeYM(false), norm(0), smoothing(0), nthreads(1), pipeline_memory(2000),
       genwig_ofvalue(0), getmaxval(false), addname(false),
       opts("Options"), isGV(false)
     {}
@@ -387,6 +389,8 @@ namespace DROMPA {
     }
 
     int32_t getSmoothing() const { return smoothing; }
+    int32_t getnthreads() const { return nthreads; }
+    int32_t getPipelineMemory() const { return pipeline_memory; }
     int32_t getChIPInputNormType() const { return norm; }
     const std::string getPrefixName() const { return oprefix; }
     const std::string getFigFileName() const { return oprefix + ".pdf"; }
@@ -393,6 +393,10 @@ void Global::setValues(const std::vector<DrompaCommand> &vopts, const Variables
   genometablefilename = getVal<std::string>(values, "gt");
   gt = readGenomeTable(genometablefilename);
 
+  // before the samples are defined, as their data may be loaded for the stats files
+  if (values.count("threads")) nthreads = getVal<int32_t>(values, "threads");
+  setLoaderThreads(nthreads);
+
   for (auto op: vopts) {
     switch(op) {
     case DrompaCommand::CHIP:
@@ -496,6 +500,7 @@ void Global::setOptsOther(MyOpt::Opts &allopts)
     ("showchr",   "Output chromosome-separated pdf files")
     ("png",     "Output with png format (Note: output each page separately)")
     (SETOPT_OVER("threads,p", int32_t, 1, 1), "number of threads to launch")
+    (SETOPT_OVER("pipeline_memory", int32_t, 2000, 0), "approximate memory (MB) for the chromosomes loaded ahead of the one being processed (0: load one by one)")
     ("help,h", "show help message")
     ;
   allopts.add(o);
@@ -508,6 +513,7 @@ void Global::setValuesOther(const Variables &values)
     includeYM = values.count("includeYM");
     ispng = values.count("png");
     showchr = values.count("showchr");
+    pipeline_memory = getVal<int32_t>(values, "pipeline_memory");
   } catch(const boost::bad_any_cast& e) {
     PRINTERR_AND_EXIT(e.what());
   }
@@ -6,7 +6,7 @@
 
 namespace {
   double getReadVal(const vChrArray &vReadArray, const SamplePairOverlayed &pair,
-                    const int32_t i, const int32_t stype)
+                    const int64_t i, const int32_t stype)
   {
     double val(0);
     if (!stype) {   // ChIP read
@@ -34,36 +34,36 @@ std::vector<genedata> ReadProfile::get_garray(const GeneDataMap &mp)
 void ReadProfile::WriteValAroundPosi(std::ofstream &out,
                                      const SamplePairOverlayed &pair,
                                      const vChrArray &vReadArray,
-                                     const int32_t posi, const std::string &strand)
+                                     const int64_t posi, const std::string &strand)
 {
-  int32_t bincenter(posi/binsize);
-  int32_t sbin(bincenter - binwidth_from_center);
-  int32_t ebin(bincenter + binwidth_from_center);
+  int64_t bincenter(posi/binsize);
+  int64_t sbin(bincenter - binwidth_from_center);
+  int64_t ebin(bincenter + binwidth_from_center);
 
   if (strand == "+") {
-    for (int32_t i=sbin; i<=ebin; ++i) out << "\t" << getReadVal(vReadArray, pair, i, stype);
+    for (int64_t i=sbin; i<=ebin; ++i) out << "\t" << getReadVal(vReadArray, pair, i, stype);
   } else {
-    for (int32_t i=ebin; i>=sbin; --i) out << "\t" << getReadVal(vReadArray, pair, i, stype);
+    for (int64_t i=ebin; i>=sbin; --i) out << "\t" << getReadVal(vReadArray, pair, i, stype);
   }
 }
 
 double ReadProfile::getAverageVal(const SamplePairOverlayed &pair,
                                   const vChrArray &vReadArray,
-                                  const int32_t sbin,
-                                  const int32_t ebin)
+                                  const int64_t sbin,
+                                  const int64_t ebin)
 {
   double sumIP(0);
-  for (int32_t i=sbin; i<=ebin; ++i) sumIP += getReadVal(vReadArray, pair, i, stype);
+  for (int64_t i=sbin; i<=ebin; ++i) sumIP += getReadVal(vReadArray, pair, i, stype);
   return getratio(sumIP, (ebin - sbin + 1));
 }
 
 double ReadProfile::getMaxVal(const SamplePairOverlayed &pair,
                               const vChrArray &vReadArray,
-                              const int32_t sbin,
-                              const int32_t ebin)
+                              const int64_t sbin,
+                              const int64_t ebin)
 {
   double maxIP(0);
-  for (int32_t i=sbin; i<=ebin; ++i) {
+  for (int64_t i=sbin; i<=ebin; ++i) {
     maxIP = std::max(maxIP, getReadVal(vReadArray, pair, i, stype));
   }
   return maxIP;
@@ -203,17 +203,16 @@ void ReadProfile::MakeFigure(const DROMPA::Global &p)
 }
 
 
-void ProfileTSS::WriteTSV_EachChr(const DROMPA::Global &p, const chrsize &chr)
+void ProfileTSS::WriteTSV_EachChr(const DROMPA::Global &p, const vChrArray &vReadArray)
 {
   DEBUGprint_FUNCStart();
 
   if(p.anno.genefile == "") PRINTERR_AND_EXIT("Please specify --gene.");
 
+  const chrsize &chr(vReadArray.getchr());
   std::string chrname(rmchr(chr.getname()));
   if (p.anno.gmp.find(chrname) == p.anno.gmp.end()) return;
 
-  vChrArray vReadArray(p, chr);
-
   for (auto &x: p.samplepair) {
     std::string file(RDataname + "." + x.first.label + ".tsv");
     std::ofstream out(file, std::ios::app);
@@ -223,7 +222,7 @@ void ProfileTSS::WriteTSV_EachChr(const DROMPA::Global &p, const chrsize &chr)
     for (auto &gene: gmp) {
       ++nsites;
 
-      int32_t position(0);
+      int64_t position(0);
       if (p.prof.isPtypeTSS()) {
         if (gene.strand == "+") position = gene.txStart;
         else                    position = gene.txEnd;
@@ -247,7 +246,7 @@ void ProfileTSS::WriteTSV_EachChr(const DROMPA::Global &p, const chrsize &chr)
 }
 
 void ProfileGene100::outputEachGene_fixedlength(std::ofstream &out, const SamplePairOverlayed &x,
-                                                const genedata &gene, const vChrArray &vReadArray, int32_t len,
+                                                const genedata &gene, const vChrArray &vReadArray, const int64_t len,
                                                 const int32_t width_from_gene)
 {
   double len100(len / (double)GENEBLOCKNUM);
@@ -257,7 +256,7 @@ void ProfileGene100::outputEachGene_fixedlength(std::ofstream &out, const Sample
 //         gene.txStart, gene.txEnd, gene.strand.c_str(), GENEBLOCKNUM, width_from_gene, len100, div100);
 
   for (int32_t i=0; i<nbin; ++i) {
-    int32_t s(0), e(0);
+    int64_t s(0), e(0);
     if (i < GENEBLOCKNUM) {
       if (gene.strand == "+") {
         s = (gene.txStart - width_from_gene + div100 *i)         / binsize;
@@ -293,12 +292,12 @@ void ProfileGene100::outputEachGene_fixedlength(std::ofstream &out, const Sample
 
 
 void ProfileGene100::outputEachGene(std::ofstream &out, const SamplePairOverlayed &x,
-                                    const genedata &gene, const vChrArray &vReadArray, int32_t len)
+                                    const genedata &gene, const vChrArray &vReadArray, const int64_t len)
 {
   double len100(len / (double)GENEBLOCKNUM);
 
   for (int32_t i=0; i<nbin; ++i) {
-    int32_t s(0), e(0);
+    int64_t s(0), e(0);
     if (gene.strand == "+") {
       s = (gene.txStart - len + len100 *i)       / binsize;
       e = (gene.txStart - len + len100 *(i+1) -1)/ binsize;
@@ -310,16 +309,15 @@ void ProfileGene100::outputEachGene(std::ofstream &out, const SamplePairOverlaye
   }
 }
 
-void ProfileGene100::WriteTSV_EachChr(const DROMPA::Global &p, const chrsize &chr)
+void ProfileGene100::WriteTSV_EachChr(const DROMPA::Global &p, const vChrArray &vReadArray)
 {
   DEBUGprint_FUNCStart();
 
   if(p.anno.genefile == "") PRINTERR_AND_EXIT("Please specify --gene.");
 
+  const chrsize &chr(vReadArray.getchr());
   std::string chrname(rmchr(chr.getname()));
   if (p.anno.gmp.find(chrname) == p.anno.gmp.end()) return;
-
-  vChrArray vReadArray(p, chr);
   //    std::ofstream out(RDataname, std::ios::app);
 
   for (auto &x: p.samplepair) {
@@ -330,7 +328,7 @@ void ProfileGene100::WriteTSV_EachChr(const DROMPA::Global &p, const chrsize &ch
     for (auto &gene: gmp) {
       ++nsites;
 
-      int32_t len(gene.length());
+      int64_t len(gene.length());
       if (gene.txEnd + len >= chr.getlen() || gene.txStart - len < 0) { // len < 1000 ||
         ++nsites_skipped;
         continue;
@@ -347,13 +345,13 @@ void ProfileGene100::WriteTSV_EachChr(const DROMPA::Global &p, const chrsize &ch
   DEBUGprint_FUNCend();
 }
 
-void ProfileBedSites::WriteTSV_EachChr(const DROMPA::Global &p, const chrsize &chr)
+void ProfileBedSites::WriteTSV_EachChr(const DROMPA::Global &p, const vChrArray &vReadArray)
 {
   DEBUGprint_FUNCStart();
 
   if(!p.anno.vbedlist.size()) PRINTERR_AND_EXIT("Please specify --bed.");
 
-  vChrArray vReadArray(p, chr);
+  const chrsize &chr(vReadArray.getchr());
 
   for (auto &x: p.samplepair) {
     std::string file(RDataname + "." + x.first.label + ".tsv");
@@ -379,13 +377,13 @@ void ProfileBedSites::WriteTSV_EachChr(const DROMPA::Global &p, const chrsize &c
   DEBUGprint_FUNCend();
 }
 
-void ProfileMULTICI::WriteTSV_EachChr(const DROMPA::Global &p, const chrsize &chr)
+void ProfileMULTICI::WriteTSV_EachChr(const DROMPA::Global &p, const vChrArray &vReadArray)
 {
   DEBUGprint_FUNCStart();
 
   if(!p.anno.vbedlist.size()) PRINTERR_AND_EXIT("Please specify --bed.");
 
-  vChrArray vReadArray(p, chr);
+  const chrsize &chr(vReadArray.getchr());
 
   std::string file(RDataname + ".tsv");
   std::ofstream out(file, std::ios::app);
@@ -400,8 +398,8 @@ void ProfileMULTICI::WriteTSV_EachChr(const DROMPA::Global &p, const chrsize &ch
         continue;
       }
 
-      int32_t sbin(bed.start/binsize);
-      int32_t ebin((bed.end-1)/binsize);
+      int64_t sbin(bed.start/binsize);
+      int64_t ebin((bed.end-1)/binsize);
 
       if (p.isaddname()) out << bed.getSiteStrTABwithNAME();
       else out << bed.getSiteStrTAB();
@@ -27,28 +27,30 @@ protected:
 
   std::vector<genedata> get_garray(const GeneDataMap &mp);
 
-  int32_t isExceedRange(const int32_t posi, const int32_t chrlen) {
+  int32_t isExceedRange(const int64_t posi, const int64_t chrlen) {
     return posi - width_from_center < 0 || posi + width_from_center >= chrlen;
   }
 
   void WriteValAroundPosi(std::ofstream &out,
                           const SamplePairOverlayed &pair,
                           const vChrArray &vReadArray,
-                          const int32_t posi,
+                          const int64_t posi,
                           const std::string &strand);
 
   double getAverageVal(const SamplePairOverlayed &pair,
                        const vChrArray &vReadArray,
-                       const int32_t sbin, const int32_t ebin);
+                       const int64_t sbin, const int64_t ebin);
   double getMaxVal(const SamplePairOverlayed &pair,
                    const vChrArray &vReadArray,
-                   const int32_t sbin, const int32_t ebin);
+                   const int64_t sbin, const int64_t ebin);
 
 public:
   ReadProfile(const DROMPA::Global &p, const int32_t _nbin=0);
   void setOutputFilename(const DROMPA::Global &p, const std::string &);
   void MakeFigure(const DROMPA::Global &p);
-  virtual void WriteTSV_EachChr(const DROMPA::Global &p, const chrsize &chr)=0;
+  virtual void WriteTSV_EachChr(const DROMPA::Global &p, const vChrArray &vReadArray)=0;
+  /* chromosomes without sites are not loaded */
+  virtual bool hasSites(const DROMPA::Global &, const chrsize &) const { return true; }
 
   virtual void printHead(const DROMPA::Global &p) {
     for (auto &x: p.samplepair) {
@@ -75,7 +77,10 @@ public:
   explicit ProfileTSS(const DROMPA::Global &p):
     ReadProfile(p) {}
 
-  void WriteTSV_EachChr(const DROMPA::Global &p, const chrsize &chr);
+  void WriteTSV_EachChr(const DROMPA::Global &p, const vChrArray &vReadArray);
+  bool hasSites(const DROMPA::Global &p, const chrsize &chr) const {
+    return p.anno.genefile == "" || p.anno.gmp.find(rmchr(chr.getname())) != p.anno.gmp.end();
+  }
 
 };
 
@@ -83,9 +88,9 @@ class ProfileGene100: public ReadProfile {
   enum {GENEBLOCKNUM=100};
 
   void outputEachGene(std::ofstream &out, const SamplePairOverlayed &x,
-                      const genedata &gene, const vChrArray &vReadArray, int32_t len);
+                      const genedata &gene, const vChrArray &vReadArray, const int64_t len);
   void outputEachGene_fixedlength(std::ofstream &out, const SamplePairOverlayed &x,
-                                  const genedata &gene, const vChrArray &vReadArray, int32_t len,
+                                  const genedata &gene, const vChrArray &vReadArray, const int64_t len,
                                   const int32_t width_from_gene);
 
 
@@ -93,7 +98,10 @@ public:
   explicit ProfileGene100(const DROMPA::Global &p):
     ReadProfile(p, GENEBLOCKNUM * 3) {}
 
-  void WriteTSV_EachChr(const DROMPA::Global &p, const chrsize &chr);
+  void WriteTSV_EachChr(const DROMPA::Global &p, const vChrArray &vReadArray);
+  bool hasSites(const DROMPA::Global &p, const chrsize &chr) const {
+    return p.anno.genefile == "" || p.anno.gmp.find(rmchr(chr.getname())) != p.anno.gmp.end();
+  }
 
   void printHead(const DROMPA::Global &p) {
     for (auto &x: p.samplepair) {
@@ -113,7 +121,7 @@ public:
   explicit ProfileBedSites(const DROMPA::Global &p):
     ReadProfile(p) {}
 
-  void WriteTSV_EachChr(const DROMPA::Global &p, const chrsize &chr);
+  void WriteTSV_EachChr(const DROMPA::Global &p, const vChrArray &vReadArray);
 };
 
 class ProfileMULTICI: public ReadProfile {
@@ -121,7 +129,7 @@ public:
   explicit ProfileMULTICI(const DROMPA::Global &p):
     ReadProfile(p) {}
 
-  void WriteTSV_EachChr(const DROMPA::Global &p, const chrsize &chr);
+  void WriteTSV_EachChr(const DROMPA::Global &p, const vChrArray &vReadArray);
 
   void printHead(const DROMPA::Global &p) {
     std::string file(RDataname + ".tsv");
@@ -143,13 +151,18 @@ void exec_PROFILE_asType(DROMPA::Global &p)
   profile.setOutputFilename(p, "PROFILE");
   profile.printHead(p);
 
+  std::vector<const chrsize *> vchr;
   for(auto &chr: p.gt) {
     if(!p.isincludeYM() && (chr.getname() == "Y" || chr.getname() == "M")) continue;
-    std::cout << "\nchr" << chr.getname() << "..";
-
-    profile.WriteTSV_EachChr(p, chr);
+    if(!profile.hasSites(p, chr)) continue;
+    vchr.emplace_back(&chr);
   }
 
+  forEachChrArray(p, vchr, [&] (vChrArray &vReadArray) {
+    std::cout << "\nchr" << vReadArray.getchr().getname() << "..";
+    profile.WriteTSV_EachChr(p, vReadArray);
+  });
+
   profile.printNumOfSites(p.samplepair.size());
   profile.MakeFigure(p);
 
@@ -1,101 +1,594 @@
 /* Copyright(c)  Ryuichiro Nakato <rnakato@iqb.u-tokyo.ac.jp>
  * All rights reserved.
  */
-#include "../submodules/SSP/common/gzstream.h"
+#include <memory>
+#include <deque>
+#include <cstring>
+#include <unordered_set>
+#include <boost/filesystem.hpp>
+#include <boost/thread.hpp>
+#include "../submodules/SSP/src/htslib-1.10.2/htslib/bgzf.h"
+#include "../submodules/SSP/src/htslib-1.10.2/htslib/tbx.h"
 #include "dd_readfile.hpp"
+#include "BigWigReader.hpp"
+#include "GzipReader.hpp"
 
 namespace {
-  void SplitBedGraphLine(std::vector<std::string> &v, const std::string &str)
+  int32_t nthreads_loader(1);
+
+  /* Arrays loaded to count the total reads of a sample without the stats file.
+     They are kept (up to MAXSIZE bytes in total, in the order of the genome table)
+     and handed out to the first load of the chromosome instead of reading the file again.
+     Chromosomes not processed by forEachChrArray are released when it starts. */
+  class LoadedArrayCache {
+    enum : uint64_t {MAXSIZE=1ULL<<30};  // 1 GB
+    boost::mutex mtx;
+    std::unordered_map<std::string, std::unordered_map<std::string, WigArray>> mp;  // chromosome -> (file and binsize -> array)
+    uint64_t size;
+
+    static std::string getKey(const std::string &filename, const int32_t binsize) {
+      return filename + "\t" + std::to_string(binsize);
+    }
+    static uint64_t getSize(const WigArray &array) { return array.size() * sizeof(int64_t); }
+
+  public:
+    LoadedArrayCache(): size(0) {}
+
+    void add(const std::string &filename, const int32_t binsize, const std::string &chrname, WigArray &&array) {
+      boost::mutex::scoped_lock lock(mtx);
+      uint64_t s(getSize(array));
+      if (size + s > MAXSIZE) return;
+      mp[chrname][getKey(filename, binsize)] = std::move(array);
+      size += s;
+    }
+
+    bool take(const std::string &filename, const int32_t binsize, const std::string &chrname, WigArray &array) {
+      boost::mutex::scoped_lock lock(mtx);
+      auto chr = mp.find(chrname);
+      if (chr == mp.end()) return false;
+      auto itr = chr->second.find(getKey(filename, binsize));
+      if (itr == chr->second.end()) return false;
+      array = std::move(itr->second);
+      size -= getSize(array);
+      chr->second.erase(itr);
+      if (chr->second.empty()) mp.erase(chr);
+      return true;
+    }
+
+    void keepOnly(const std::vector<const chrsize *> &vchr) {
+      boost::mutex::scoped_lock lock(mtx);
+      std::unordered_map<std::string, std::unordered_map<std::string, WigArray>> kept;
+      for (auto chr: vchr) {
+        auto itr = mp.find(chr->getrefname());
+        if (itr == mp.end()) continue;
+        kept[itr->first] = std::move(itr->second);
+        mp.erase(itr);
+      }
+      for (auto &x: mp) {
+        for (auto &y: x.second) size -= getSize(y.second);
+      }
+      mp = std::move(kept);
+    }
+
+    void clear() {
+      boost::mutex::scoped_lock lock(mtx);
+      mp.clear();
+      size = 0;
+    }
+  };
+  LoadedArrayCache loadedArrays;
+
+  /* Line reader on a large buffer of the stream.
+     Each line is returned in place (terminated by '\0' instead of '\n') without copying. */
+  class LineReader {
+    enum {BUFSIZE=1<<22};  // 4 MB
+    std::istream &in;
+    std::vector<char> buf;
+    size_t pos;
+    size_t len;
+    int64_t remaining;  // bytes to be read from the stream (< 0: until EOF)
+    int64_t nread;
+
+    bool fill() {
+      if (!remaining) return false;
+      std::copy(buf.begin() + pos, buf.begin() + len, buf.begin());
+      len -= pos;
+      pos = 0;
+      if (len == buf.size() -1) buf.resize(buf.size() *2);  // a line longer than the buffer
+
+      int64_t size(buf.size() -1 - len);
+      if (remaining > 0) size = std::min(size, remaining);
+      in.read(&buf[len], size);
+      int64_t n(in.gcount());
+      len += n;
+      nread += n;
+      if (remaining > 0) remaining -= n;
+      return n > 0;
+    }
+
+  public:
+    LineReader(std::istream &i, const int64_t nbyte=-1):
+      in(i), buf(BUFSIZE +1), pos(0), len(0), remaining(nbyte), nread(0)
+    {}
+
+    bool getline(char *&begin, char *&end) {
+      char *p;
+      while (!(p = static_cast<char *>(memchr(&buf[pos], '\n', len - pos)))) {
+        if (!fill()) {
+          if (pos == len) return false;
+          p = &buf[len];  // the last line without '\n'
+          break;
+        }
+      }
+      begin = &buf[pos];
+      end = p;
+      pos = std::min(static_cast<size_t>(p - &buf[0]) +1, len);
+      if (end > begin && end[-1] == '\r') --end;
+      *end = '\0';
+      return true;
+    }
+
+    /* bytes of the stream consumed by the lines returned so far */
+    int64_t getoffset() const { return nread - (len - pos); }
+  };
+
+  /* BGZF (bgzip) files are decompressed by htslib with the threads of --threads */
+  bool isBgzf(const std::string &filename)
+  {
+    std::ifstream in(filename, std::ios::binary);
+    unsigned char h[16];
+    if (!in.read(reinterpret_cast<char *>(h), sizeof(h))) return false;
+    // gzip header with the extra subfield "BC"
+    return h[0] == 0x1f && h[1] == 0x8b && (h[3] & 4) && h[12] == 'B' && h[13] == 'C';
+  }
+
+  class BgzfStreamBuf: public std::streambuf {
+    enum {BUFSIZE=1<<16};
+    BGZF *fp;
+    std::vector<char> buf;
+
+  public:
+    BgzfStreamBuf(const std::string &filename, const int32_t nthreads):
+      fp(bgzf_open(filename.c_str(), "r")), buf(BUFSIZE)
+    {
+      if (!fp) PRINTERR_AND_EXIT("cannot open " << filename);
+      if (nthreads > 1) bgzf_mt(fp, nthreads, 256);
+    }
+    ~BgzfStreamBuf() { bgzf_close(fp); }
+
+  protected:
+    int_type underflow() {
+      if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+      ssize_t n(bgzf_read(fp, buf.data(), buf.size()));
+      if (n <= 0) return traits_type::eof();
+      setg(buf.data(), buf.data(), buf.data() + n);
+      return traits_type::to_int_type(*gptr());
+    }
+  };
+
+  class BgzfStream: public std::istream {
+    BgzfStreamBuf sbuf;
+  public:
+    BgzfStream(const std::string &filename, const int32_t nthreads):
+      std::istream(nullptr), sbuf(filename, nthreads)
+    {
+      rdbuf(&sbuf);
+    }
+  };
+
+  inline bool isDelimiter(const char c) { return c == ' ' || c == '\t'; }
+
+  inline const char * skipField(const char *p) {
+    while (*p && !isDelimiter(*p)) ++p;
+    return p;
+  }
+
+  inline int64_t parseInt(const char *&p) {
+    bool minus(*p == '-');
+    if (minus) ++p;
+    int64_t val(0);
+    for (; *p >= '0' && *p <= '9'; ++p) val = val*10 + (*p - '0');
+    return minus ? -val : val;
+  }
+
+  inline bool isField(const char *begin, const char *end, const std::string &str) {
+    return static_cast<size_t>(end - begin) == str.size() && !str.compare(0, str.size(), begin, end - begin);
+  }
+
+  /* Wig (.wig/.wig.gz) files are decompressed and parsed once in the order of the file.
+     The data of the chromosomes passed before the requested one are kept until they are requested,
+     and each chromosome is taken out of the memory when it is requested.
+     When an already-taken chromosome is requested again, the file is read again from the start,
+     and the other chromosomes already taken are skipped instead of being kept. */
+  class WigValue {
+  public:
+    int64_t pos;  // 1-based
+    double val;
+    WigValue(const int64_t p, const double v): pos(p), val(v) {}
+  };
+
+  class WigFileReader {
+    std::string filename;
+    bool compressed;
+    std::unique_ptr<std::istream> in;
+    std::unique_ptr<LineReader> reader;
+    bool eof;
+
+    // the block being read
+    std::string chrname;
+    bool fixedstep;
+    int64_t nextpos;
+    int64_t step;
+
+    std::unordered_map<std::string, std::vector<WigValue>> stash;
+    std::unordered_set<std::string> seen;
+    std::unordered_set<std::string> taken;  // kept over reopening
+
+    /* the array of the current block (nullptr: skipped) */
+    std::vector<WigValue> * getStash(const std::string &name) {
+      if (chrname == "" || (chrname != name && taken.count(chrname))) return nullptr;
+      return &stash[chrname];
+    }
+
+    static std::string getField(const std::string &lineStr, const std::string &key) {
+      size_t s(lineStr.find(key + "="));
+      if (s == std::string::npos) return "";
+      s += key.size() +1;
+      return lineStr.substr(s, lineStr.find_first_of(" \t", s) - s);
+    }
+
+    void open() {
+      if (compressed && isBgzf(filename)) in.reset(new BgzfStream(filename, nthreads_loader));
+      else if (compressed) in.reset(new GzipStream(filename));  // other gzip files are decoded in chunks
+      else in.reset(new std::ifstream(filename));
+      if (!*in) PRINTERR_AND_EXIT("cannot open " << filename);
+      reader.reset(new LineReader(*in));
+      eof = false;
+      chrname = "";
+      stash.clear();
+      seen.clear();
+    }
+
+    void setBlock(const std::string &lineStr) {
+      chrname = getField(lineStr, "chrom");
+      fixedstep = !lineStr.compare(0, 9, "fixedStep");
+      if (fixedstep) {
+        std::string start(getField(lineStr, "start"));
+        std::string st(getField(lineStr, "step"));
+        if (start == "") PRINTERR_AND_EXIT("Error: fixedStep without start in " << filename << ": " << lineStr);
+        nextpos = stoll(start);
+        step = st == "" ? 1 : stoll(st);
+      }
+      seen.insert(chrname);
+    }
+
+    /* reads blocks until a block of another chromosome follows the requested one */
+    void readUntil(const std::string &name) {
+      std::vector<WigValue> *array(getStash(name));
+      char *begin, *end;
+      while (reader->getline(begin, end)) {
+        if (begin == end || *begin == '#' || !strncmp(begin, "track", 5) || !strncmp(begin, "browser", 7)) continue;
+        if (!strncmp(begin, "variableStep", 12) || !strncmp(begin, "fixedStep", 9)) {
+          bool done(chrname == name);
+          setBlock(std::string(begin, end));
+          array = getStash(name);
+          if (done && chrname != name) return;
+          continue;
+        }
+        if (!array) continue;
+        if (fixedstep) {
+          array->emplace_back(nextpos, strtod(begin, nullptr));
+          nextpos += step;
+        } else {
+          const char *p(begin);
+          int64_t pos(parseInt(p));
+          if (!isDelimiter(*p)) PRINTERR_AND_EXIT("Error: invalid line in " << filename << ": " << begin);
+          array->emplace_back(pos, strtod(p+1, nullptr));
+        }
+      }
+      eof = true;
+    }
+
+  public:
+    boost::mutex mtx;
+
+    WigFileReader(const std::string &file, const bool c):
+      filename(file), compressed(c), eof(true),
+      chrname(""), fixedstep(false), nextpos(0), step(0)
+    {}
+
+    std::vector<WigValue> take(const std::string &name) {
+      if (!in || (seen.count(name) && !stash.count(name))) open();
+      if (!eof && !(seen.count(name) && chrname != name)) readUntil(name);
+
+      std::vector<WigValue> v;
+      auto itr = stash.find(name);
+      if (itr != stash.end()) {
+        v.swap(itr->second);
+        stash.erase(itr);
+      }
+      taken.insert(name);
+      return v;
+    }
+  };
+
+  WigFileReader & getWigFileReader(const std::string &filename, const bool compressed)
+  {
+    static boost::mutex mtx;
+    static std::unordered_map<std::string, std::unique_ptr<WigFileReader>> mp;
+
+    boost::mutex::scoped_lock lock(mtx);
+    auto &p = mp[filename];
+    if (!p) p.reset(new WigFileReader(filename, compressed));
+    return *p;
+  }
+
+  void readWig(WigArray &array, const std::string &filename, const bool compressed,
+               const std::string &chrname, const int32_t binsize)
   {
-    size_t current(0), found;
-    while((found = str.find_first_of(" \t", current)) != std::string::npos) {
-      v.emplace_back(std::string(str, current, found - current));
-      current = found + 1;
+    auto &reader = getWigFileReader(filename, compressed);
+    std::vector<WigValue> v;
+    {
+      boost::mutex::scoped_lock lock(reader.mtx);
+      v = reader.take(chrname);
+    }
+    for (auto &x: v) {
+      int64_t i((x.pos -1)/binsize);
+      if (i >= 0 && i < static_cast<int64_t>(array.size())) array.setval(i, x.val);
     }
-    v.emplace_back(std::string(str, current, str.size() - current));
     return;
   }
 
-  template <class T>
-  void readWig(T &in, WigArray &array, const std::string &chrname, const int binsize)
+  /* byte ranges of each chromosome in a bedGraph file, made in one pass at the first access.
+     The index is kept in memory and also saved to <filename>.chrindex,
+     which is reused while the size and mtime of the bedGraph are unchanged. */
+  class ByteRange {
+  public:
+    int64_t begin;
+    int64_t end;
+    ByteRange(const int64_t b, const int64_t e): begin(b), end(e) {}
+  };
+  using BedGraphIndex = std::unordered_map<std::string, std::vector<ByteRange>>;
+
+  std::string getBedGraphIndexHeader(const std::string &filename)
+  {
+    return "#bedGraph index\t" + std::to_string(boost::filesystem::file_size(filename))
+      + "\t" + std::to_string(boost::filesystem::last_write_time(filename));
+  }
+
+  bool readBedGraphIndex(BedGraphIndex &index, const std::string &filename)
   {
-    std::string head("chrom="+ chrname);
-    int32_t on(0);
+    std::ifstream in(filename + ".chrindex");
+    if (!in) return false;
 
     std::string lineStr;
-    while (!in.eof()) {
-      getline(in, lineStr);
-      if(lineStr.empty() || !lineStr.find("track")) continue;
-      if(on && isStr(lineStr, "chrom=")) break;
-      if(isStr(lineStr, head)) {
-        on=1;
-        continue;
-      }
-      if(!on) continue;
+    getline(in, lineStr);
+    if (lineStr != getBedGraphIndexHeader(filename)) return false;
+
+    while (getline(in, lineStr)) {
+      if (lineStr.empty()) continue;
       std::vector<std::string> v;
-      SplitBedGraphLine(v, lineStr);
-      array.setval((stoi(v[0])-1)/binsize, stod(v[1]));
+      ParseLine(v, lineStr, '\t');
+      if (v.size() < 3) return false;
+      index[v[0]].emplace_back(stoll(v[1]), stoll(v[2]));
     }
-    return;
+    return true;
   }
 
-  void readBedGraph(WigArray &array, const std::string &filename,
-                    const std::string &chrname, const int32_t binsize)
+  void writeBedGraphIndex(const BedGraphIndex &index, const std::string &filename)
+  {
+    // the index is only a cache: the directory may be read-only
+    std::ofstream out(filename + ".chrindex");
+    if (!out) return;
+    out << getBedGraphIndexHeader(filename) << std::endl;
+    for (auto &x: index) {
+      for (auto &r: x.second) out << x.first << "\t" << r.begin << "\t" << r.end << std::endl;
+    }
+  }
+
+  BedGraphIndex makeBedGraphIndex(const std::string &filename)
   {
     std::ifstream in(filename);
     if (!in) PRINTERR_AND_EXIT("cannot open " << filename);
 
-    DEBUGprint_FUNCStart();
+    BedGraphIndex index;
+    std::string chrname("");
+    std::vector<ByteRange> *block(nullptr);
+    LineReader reader(in);
+    int64_t offset(0);
+    char *begin, *end;
+    while (reader.getline(begin, end)) {
+      int64_t next(reader.getoffset());
+      if (begin != end) {
+        const char *p(skipField(begin));
+        if (!block || !isField(begin, p, chrname)) {
+          chrname = std::string(begin, p - begin);
+          block = &index[chrname];
+          block->emplace_back(offset, next);
+        }
+        block->back().end = next;
+      }
+      offset = next;
+    }
+    return index;
+  }
 
-    std::vector<int32_t> array_ncount(array.size());
+  const BedGraphIndex & getBedGraphIndex(const std::string &filename)
+  {
+    static boost::mutex mtx;
+    static std::unordered_map<std::string, BedGraphIndex> mp;
 
-    int32_t on(0);
-    std::string lineStr;
-    while (!in.eof()) {
-      getline(in, lineStr);
-      if (lineStr.empty()) continue;
-      std::vector<std::string> v;
-      SplitBedGraphLine(v, lineStr);
-      if (v[0] != chrname) {
-        if (!on) continue;
-        else break;
-      }
-      if (!on) on=1;
+    boost::mutex::scoped_lock lock(mtx);
+    auto itr = mp.find(filename);
+    if (itr != mp.end()) return itr->second;
 
-      if(v.size() < 4) {
-        std::cerr << "\nError: invalid delimitar in BedGraph file?: " << lineStr << std::endl;
-        exit(1);
-      }
+    auto &index = mp[filename];
+    if (!readBedGraphIndex(index, filename)) {
+      index = makeBedGraphIndex(filename);
+      writeBedGraphIndex(index, filename);
+    }
+    return index;
+  }
+
+  /* Average of the values of the intervals overlapping each bin.
+     For intervals sorted by start, only the last bin of the previous interval can be shared
+     with the next one, so it is the only bin accumulated before being set.
+     Unsorted intervals are detected (add() returns false) and read again with a counter per bin. */
+  class BinAverage {
+    WigArray &array;
+    bool counting;
+    std::vector<int32_t> ncount;
+    int64_t bin;
+    double sum;
+    int32_t n;
+
+    void flush() {
+      if (bin >= 0) array.setval(bin, sum/n);
+    }
+
+  public:
+    BinAverage(WigArray &a, const bool c):
+      array(a), counting(c), ncount(c ? a.size() : 0), bin(-1), sum(0), n(0)
+    {}
 
-      double val(0);
-      if(v[3] == "") val = 0; else val = stod(v[3]);
-      //std::cout << chrname << "\t" << v[0] << "\t" << binsize << "\t" << val << "\t" << v[2] << "\t" << std::endl;
-
-      try {
-        int32_t start(stoi(v[1]));
-        int32_t end(stoi(v[2])-1);
-//        if (start%binsize) PRINTERR_AND_EXIT("ERROR: invalid start position: " << start << " for binsize " << binsize);
-        int32_t s(start/binsize);
-        int32_t e(end/binsize);
-//        for (int32_t i=s; i<=e; ++i) array.setval(i, val);
-        for (int32_t i=s; i<=e; ++i) {
+    bool add(const int64_t s, const int64_t e, const double val) {
+      if (counting) {
+        for (int64_t i=s; i<=e; ++i) {
           array.addval(i, val);
-          ++array_ncount[i];
+          ++ncount[i];
         }
-      } catch (const boost::bad_any_cast& e) {
-        PRINTERR_AND_EXIT("Error: invalid value in BedGraph. " + lineStr + ": :" + std::string(e.what()));
+        return true;
       }
+      if (e < s) return true;
+      if (s < bin) return false;
+
+      if (s == bin) {
+        sum += val;
+        ++n;
+        if (e == s) return true;
+        flush();
+      } else {
+        flush();
+        array.setval(s, val);
+      }
+      for (int64_t i=s+1; i<e; ++i) array.setval(i, val);
+      bin = e;
+      sum = val;
+      n = 1;
+      return true;
+    }
 
+    void finish() {
+      if (counting) {
+        for (size_t i=0; i<array.size(); ++i) {
+          if (ncount[i]>1) array.divideval(i, ncount[i]);
+        }
+      } else {
+        flush();
+      }
     }
-    in.close();
+  };
 
-    for (size_t i=0; i<array.size(); ++i) {
-//       std::cout << "i: " << std::to_string(i) << " array_ncount : " << std::to_string(array_ncount[i]) << " array : " << std::to_string(array[i]) << std::endl;
-        if (array_ncount[i]>1) array.divideval(i, array_ncount[i]);
+  /* adds a bedGraph line of chrname (other chromosomes are ignored). false: not sorted */
+  bool addBedGraphLine(BinAverage &average, const char *begin, const std::string &chrname, const int32_t binsize)
+  {
+    const char *p(skipField(begin));
+    if (!isField(begin, p, chrname)) return true;
+
+    const char *q(*p ? skipField(p+1) : p);
+    const char *r(*q ? skipField(q+1) : q);
+    if (!*r) {
+      std::cerr << "\nError: invalid delimitar in BedGraph file?: " << begin << std::endl;
+      exit(1);
     }
 
-    DEBUGprint_FUNCend();
-    return;
+    const char *start(p+1), *ends(q+1);
+    int64_t s(parseInt(start)/binsize);
+    int64_t e((parseInt(ends)-1)/binsize);
+    return average.add(s, e, strtod(r+1, nullptr));
+  }
+
+  /* reads the lines of chrname in [begin, end) bytes of the stream */
+  bool readBedGraph(BinAverage &average, std::istream &in, const std::string &chrname,
+                    const int32_t binsize, const ByteRange &range)
+  {
+    in.clear();
+    in.seekg(range.begin);
+
+    LineReader reader(in, range.end - range.begin);
+    char *begin, *end;
+    while (reader.getline(begin, end)) {
+      if (begin == end) continue;
+      if (!addBedGraphLine(average, begin, chrname, binsize)) return false;
+    }
+    return true;
+  }
+
+  /* read(average) returns false when the intervals are not sorted */
+  template <class F>
+  void averageIntervals(WigArray &array, F read)
+  {
+    for (auto counting: {false, true}) {
+      BinAverage average(array, counting);
+      if (read(average)) {
+        average.finish();
+        return;
+      }
+      array.reset(array.size());
+    }
+  }
+
+  void loadBedGraph(WigArray &array, const std::string &filename, const std::string &chrname,
+                    const int32_t binsize, const std::vector<ByteRange> &vrange)
+  {
+    std::ifstream in(filename);
+    if (!in) PRINTERR_AND_EXIT("cannot open " << filename);
+
+    averageIntervals(array, [&] (BinAverage &average) {
+        for (auto &r: vrange) {
+          if (!readBedGraph(average, in, chrname, binsize, r)) return false;
+        }
+        return true;
+      });
+  }
+
+  /* bgzip-compressed bedGraph with a tabix (.tbi/.csi) index: only the records of chrname are decompressed */
+  void loadBedGraphTabix(WigArray &array, const std::string &filename, const std::string &chrname,
+                         const int32_t binsize)
+  {
+    if (!isBgzf(filename)) PRINTERR_AND_EXIT(filename << " is not compressed by bgzip. Use bgzip and tabix -p bed.");
+    tbx_t *tbx(tbx_index_load(filename.c_str()));
+    if (!tbx) PRINTERR_AND_EXIT("tabix index of " << filename << " not found. Use tabix -p bed.");
+    htsFile *fp(hts_open(filename.c_str(), "r"));
+    if (!fp) PRINTERR_AND_EXIT("cannot open " << filename);
+    if (nthreads_loader > 1) hts_set_threads(fp, nthreads_loader);
+
+    averageIntervals(array, [&] (BinAverage &average) {
+        hts_itr_t *itr(tbx_itr_querys(tbx, chrname.c_str()));
+        if (!itr) return true;  // chrname is not in the file
+        bool sorted(true);
+        kstring_t str = {0, 0, nullptr};
+        while (sorted && tbx_itr_next(fp, tbx, itr, &str) >= 0) {
+          sorted = addBedGraphLine(average, str.s, chrname, binsize);
+        }
+        free(str.s);
+        tbx_itr_destroy(itr);
+        return sorted;
+      });
+
+    hts_close(fp);
+    tbx_destroy(tbx);
+  }
+
+  const BigWigReader & getBigWigReader(const std::string &filename)
+  {
+    static boost::mutex mtx;
+    static std::unordered_map<std::string, std::unique_ptr<BigWigReader>> mp;
+
+    boost::mutex::scoped_lock lock(mtx);
+    auto &p = mp[filename];
+    if (!p) p.reset(new BigWigReader(filename));
+    return *p;
   }
 
   void funcWig(WigArray &array, const std::string &filename,
@@ -103,10 +596,7 @@ namespace {
   {
     DEBUGprint_FUNCStart();
 
-    std::ifstream in(filename);
-    if (!in) PRINTERR_AND_EXIT("cannot open " << filename);
-    readWig(in, array, chrname, binsize);
-    in.close();
+    readWig(array, filename, false, chrname, binsize);
 
     DEBUGprint_FUNCend();
   }
@@ -116,33 +606,57 @@ namespace {
   {
     DEBUGprint_FUNCStart();
 
-    igzstream in(filename.c_str());
-    readWig(in, array, chrname, binsize);
+    readWig(array, filename, true, chrname, binsize);
 
     DEBUGprint_FUNCend();
   }
 
+  /* For a binsize not smaller than a zoom level of the bigWig, the precomputed summaries are used.
+     Each bin is the mean over the bases with data, as the average of equal-length intervals is. */
+  void loadBigWigZoom(WigArray &array, const BigWigReader &reader, const std::string &chrname,
+                      const int32_t binsize, const uint32_t reduction)
+  {
+    std::vector<double> vsum(array.size(), 0);
+    std::vector<double> vcount(array.size(), 0);
+    reader.readZoomRecords(chrname, reduction, nthreads_loader, [&] (const std::vector<BigWigReader::ZoomRecord> &v) {
+        for (auto &x: v) {
+          // a record across bins is split in proportion to the overlap
+          double len(x.end - x.start);
+          int64_t e(std::min(static_cast<int64_t>(array.size()) -1, (x.end -1)/binsize));
+          for (int64_t i=x.start/binsize; i<=e; ++i) {
+            double r((std::min(x.end, (i+1)*binsize) - std::max(x.start, i*binsize)) / len);
+            vsum[i]   += x.sum * r;
+            vcount[i] += x.validCount * r;
+          }
+        }
+      });
+    for (size_t i=0; i<array.size(); ++i) {
+      if (vcount[i] > 0) array.setval(i, vsum[i] / vcount[i]);
+    }
+  }
+
   void funcBigWig(WigArray &array, const std::string &filename,
                   const int32_t binsize, const std::string &chrname)
   {
     DEBUGprint_FUNCStart();
 
-    int32_t fd(0);
-    char tmpfile[] = "/tmp/DROMPAplus_bigWigToBedGraph_XXXXXXXX";
-    if ((fd = mkstemp(tmpfile)) < 0) {
-      perror("mkstemp");
-      //      fd = EXIT_FAILURE;
-    }
-    std::string command = "bigWigToBedGraph -chrom=chr" + rmchr(chrname) + " " + filename + " " + std::string(tmpfile);
-    int32_t return_code = system(command.c_str());
-    if (WEXITSTATUS(return_code)) {
-      PRINTERR_AND_EXIT("Error: command " << command
-                        << "return nonzero status. "
-                        << "Add the PATH to 'DROMPAplus/otherbins'.");
+    const BigWigReader &reader = getBigWigReader(filename);
+    uint32_t reduction(reader.getZoomReduction(binsize));
+    if (reduction) {
+      loadBigWigZoom(array, reader, chrname, binsize, reduction);
+      DEBUGprint_FUNCend();
+      return;
     }
-    readBedGraph(array, std::string(tmpfile), chrname, binsize);
-    unlink(tmpfile);
-    close(fd);
+
+    averageIntervals(array, [&] (BinAverage &average) {
+        bool sorted(true);
+        reader.readIntervals(chrname, nthreads_loader, [&] (const std::vector<BigWigReader::Interval> &v) {
+            for (auto &x: v) {
+              if (sorted) sorted = average.add(x.start/binsize, (x.end-1)/binsize, x.val);
+            }
+          });
+        return sorted;
+      });
 
     DEBUGprint_FUNCend();
   }
@@ -152,19 +666,84 @@ namespace {
   {
     DEBUGprint_FUNCStart();
 
-    readBedGraph(array, filename, chrname, binsize);
+    if (filename.size() > 3 && !filename.compare(filename.size() -3, 3, ".gz")) {
+      loadBedGraphTabix(array, filename, chrname, binsize);
+    } else {
+      const BedGraphIndex &index = getBedGraphIndex(filename);
+      auto itr = index.find(chrname);
+      if (itr != index.end()) loadBedGraph(array, filename, chrname, binsize, itr->second);
+    }
 
     DEBUGprint_FUNCend();
   }
 }
 
+namespace {
+  void loadChrArrays(std::vector<ChrArray> &varray, const DROMPA::Global &p,
+                     const std::vector<const std::pair<const std::string, SampleInfo> *> &vsample,
+                     const chrsize &chr, const size_t s, const size_t e)
+  {
+    for (size_t i=s; i<e; ++i) {
+      clock_t t1,t2;
+      t1 = clock();
+      varray[i] = ChrArray(p, *vsample[i], chr);
+      t2 = clock();
+      PrintTime(t1, t2, "ChrArray new");
+    }
+  }
+
+  /* Approximate memory of the vChrArray of a chromosome:
+     the bin array of each sample (smoothed in place) and its ChrArray with the stats
+     and the read numbers per chromosome. Buffers used only while decoding are not counted. */
+  uint64_t getChrArraySize(const DROMPA::Global &p, const chrsize &chr)
+  {
+    uint64_t size(0);
+    for (auto &x: p.vsinfo.getarray()) {
+      size += (chr.getlen()/x.second.getbinsize() +1) * sizeof(int64_t);
+      size += sizeof(ChrArray) + WigStats::getDistSize();
+      size += x.second.gettotalreadnum_chr().size() * (sizeof(std::pair<const std::string, int32_t>) + 2*sizeof(void *));
+    }
+    return size;
+  }
+
+  /* Stops the producer of forEachChrArray and waits for it,
+     also when the function called for a chromosome throws. */
+  class ProducerGuard {
+    boost::thread &producer;
+    boost::mutex &mtx;
+    boost::condition_variable &cond;
+    bool &stop;
+
+  public:
+    ProducerGuard(boost::thread &_producer, boost::mutex &_mtx, boost::condition_variable &_cond, bool &_stop):
+      producer(_producer), mtx(_mtx), cond(_cond), stop(_stop)
+    {}
+    ~ProducerGuard() {
+      {
+        boost::mutex::scoped_lock lock(mtx);
+        stop = true;
+        cond.notify_all();
+      }
+      producer.join();
+    }
+  };
+}
+
+void setLoaderThreads(const int32_t nthreads)
+{
+  nthreads_loader = std::max(1, nthreads);
+}
+
 WigArray loadWigData(const std::string &filename, const SampleInfo &x, const chrsize &chr)
 {
   int32_t binsize(x.getbinsize());
-  int32_t nbin(chr.getlen()/binsize +1);
+  int64_t nbin(chr.getlen()/binsize +1);
 
-  WigArray array(nbin, 0);
   std::string chrname(chr.getrefname());
+  WigArray array;
+  if (loadedArrays.take(filename, binsize, chrname, array)) return array;
+
+  array.reset(nbin);
   WigType iftype(x.getiftype());
 
   if (iftype == WigType::NONE) PRINTERR_AND_EXIT("Suffix error of "<< filename <<". please specify --iftype option.");
@@ -178,18 +757,30 @@ WigArray loadWigData(const std::string &filename, const SampleInfo &x, const chr
   return array;
 }
 
+void keepWigData(const std::string &filename, const SampleInfo &x, const chrsize &chr, WigArray &&array)
+{
+  loadedArrays.add(filename, x.getbinsize(), chr.getrefname(), std::move(array));
+}
 
-vChrArray::vChrArray(const DROMPA::Global &p, const chrsize &_chr):
+vChrArray::vChrArray(const DROMPA::Global &p, const chrsize &_chr, const bool quiet):
   chr(_chr)
 {
-  std::cout << "Load sample data..";
-  for (auto &x: p.vsinfo.getarray()) {
-    clock_t t1,t2;
-    t1 = clock();
-    arrays[x.first] = ChrArray(p, x, chr);
-    t2 = clock();
-    PrintTime(t1, t2, "ChrArray new");
+  if (!quiet) std::cout << "Load sample data..";
+  std::vector<const std::pair<const std::string, SampleInfo> *> vsample;
+  for (auto &x: p.vsinfo.getarray()) vsample.emplace_back(&x);
+
+  // samples are loaded, smoothed and summarized in parallel, each in its own ChrArray
+  size_t nsample(vsample.size());
+  size_t nthre(std::max(1, std::min(p.getnthreads(), static_cast<int32_t>(nsample))));
+  std::vector<ChrArray> varray(nsample);
+  boost::thread_group agroup;
+  for (size_t i=0; i<nthre; ++i) {
+    agroup.create_thread(boost::bind(loadChrArrays, boost::ref(varray), boost::cref(p), boost::cref(vsample),
+                                     boost::cref(chr), nsample*i/nthre, nsample*(i+1)/nthre));
   }
+  agroup.join_all();
+
+  for (size_t i=0; i<nsample; ++i) arrays[vsample[i]->first] = std::move(varray[i]);
 
 #ifdef DEBUG
   std::cout << "all WigArray:" << std::endl;
@@ -203,3 +794,56 @@ vChrArray::vChrArray(const DROMPA::Global &p, const chrsize &_chr):
   }
 #endif
 }
+
+void forEachChrArray(const DROMPA::Global &p, const std::vector<const chrsize *> &vchr,
+                     const std::function<void(vChrArray &)> &func)
+{
+  uint64_t maxsize(static_cast<uint64_t>(p.getPipelineMemory()) << 20);
+  boost::mutex mtx;
+  boost::condition_variable cond;
+  std::deque<std::unique_ptr<vChrArray>> queue;
+  uint64_t size(0);  // arrays being loaded, queued or processed
+  bool stop(false);
+
+  // arrays cached for chromosomes that are not processed here are never taken
+  loadedArrays.keepOnly(vchr);
+
+  // the loader does not print since it runs while func is writing
+  boost::thread producer([&] () {
+    for (auto chr: vchr) {
+      uint64_t s(getChrArraySize(p, *chr));
+      {
+        boost::mutex::scoped_lock lock(mtx);
+        // a chromosome exceeding the limit is loaded when no other one is in memory
+        while (!stop && size && size + s > maxsize) cond.wait(lock);
+        if (stop) return;
+        size += s;
+      }
+      std::unique_ptr<vChrArray> array(new vChrArray(p, *chr, true));
+      boost::mutex::scoped_lock lock(mtx);
+      if (stop) return;
+      queue.emplace_back(std::move(array));
+      cond.notify_all();
+    }
+  });
+
+  {
+    ProducerGuard guard(producer, mtx, cond, stop);
+    for (size_t i=0; i<vchr.size(); ++i) {
+      std::unique_ptr<vChrArray> array;
+      {
+        boost::mutex::scoped_lock lock(mtx);
+        while (queue.empty()) cond.wait(lock);
+        array = std::move(queue.front());
+        queue.pop_front();
+      }
+      func(*array);
+      array.reset();
+
+      boost::mutex::scoped_lock lock(mtx);
+      size -= getChrArraySize(p, *vchr[i]);
+      cond.notify_all();
+    }
+  }
+  loadedArrays.clear();
+}
@@ -7,15 +7,20 @@
 #include <unordered_map>
 #include <string>
 #include <vector>
+#include <functional>
 #include "dd_gv.hpp"
 #include "../submodules/SSP/common/seq.hpp"
 
+/* number of threads used to decode a bigWig file */
+void setLoaderThreads(const int32_t nthreads);
 WigArray loadWigData(const std::string &filename, const SampleInfo &x, const chrsize &chr);
+/* keeps an array loaded in advance so that the next loadWigData of the chromosome returns it */
+void keepWigData(const std::string &filename, const SampleInfo &x, const chrsize &chr, WigArray &&array);
 
 class ChrArray {
 public:
   int32_t binsize;
-  int32_t nbin;
+  int64_t nbin;
   WigArray array;
   WigStats stats;
   int32_t totalreadnum;
@@ -48,13 +53,20 @@ class vChrArray {
   std::unordered_map<std::string, ChrArray> arrays;
 
 public:
-  vChrArray(const DROMPA::Global &p, const chrsize &_chr);
+  vChrArray(const DROMPA::Global &p, const chrsize &_chr, const bool quiet=false);
 
   const ChrArray & getArray(const std::string &str) const {
     return arrays.at(str);
   }
   const chrsize & getchr() const { return chr; }
-  int32_t getchrlen() const { return chr.getlen(); }
+  int64_t getchrlen() const { return chr.getlen(); }
 };
 
+/* Calls func with the vChrArray of each chromosome of vchr in order.
+ * The next chromosomes are loaded and smoothed in another thread while func is running,
+ * as long as the arrays loaded and not yet processed fit in --pipeline_memory
+ * (estimated from the bin arrays and the per-sample stats, so the limit is approximate). */
+void forEachChrArray(const DROMPA::Global &p, const std::vector<const chrsize *> &vchr,
+                     const std::function<void(vChrArray &)> &func);
+
 #endif /* _DD_READFILE_H_ */
@@ -75,6 +75,9 @@ SampleInfo::SampleInfo(const std::string &filename,
     else if (v[last] == "gz" && (v[last-1] == "wig" || v[last-1] == "wiggle")) {
       iftype = WigType::COMPRESSWIG;
       --last;
+    } else if (v[last] == "gz" && (v[last-1] == "bedGraph" || v[last-1] == "BedGraph" || v[last-1] == "bedgraph")) {
+      iftype = WigType::BEDGRAPH;  // bgzip + tabix
+      --last;
     } else if (v[last] == "bedGraph" || v[last] == "BedGraph" || v[last] == "bedgraph") iftype = WigType::BEDGRAPH;
     else if (v[last] == "bw" || v[last] == "bigwig" || v[last] == "bigWig"|| v[last] == "BigWig") iftype = WigType::BIGWIG;
     else PRINTERR_AND_EXIT("invalid postfix: " << filename);
@@ -159,6 +162,8 @@ void SampleInfo::gettotalreadnum(const std::string &filename, const std::vector<
       WigArray array(loadWigData(filename, *this, chr));
       totalreadnum_chr[chr.getname()] = array.getArraySum();
       totalreadnum += totalreadnum_chr[chr.getname()];
+      // reused by the first load of the chromosome
+      keepWigData(filename, *this, chr, std::move(array));
     }
     OutputStatsfileForOtherData(filename, statsfile, gt, totalreadnum_chr, totalreadnum);
   }
@@ -272,7 +277,7 @@ void SamplePairEach::setScalingFactor(const int32_t normtype,
   DEBUGprint_FUNCend();
 }
 
-void SamplePairEach::genEnrichWig(const vChrArray &vReadArray, const std::string &chrname, const int32_t chrlen)
+void SamplePairEach::genEnrichWig(const vChrArray &vReadArray, const std::string &chrname, const int64_t chrlen)
 {
   DEBUGprint_FUNCStart();
 
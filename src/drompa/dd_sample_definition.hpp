@@ -97,7 +97,7 @@ public:
 
   void setScalingFactor(const int32_t normtype, const vChrArray &vReadArray, const std::string &chrname);
 
-  void genEnrichWig(const vChrArray &vReadArray, const std::string &chrname, const int32_t chrlen);
+  void genEnrichWig(const vChrArray &vReadArray, const std::string &chrname, const int64_t chrlen);
 
   void peakcall_withInput(const vChrArray &vReadArray, const std::string &chrname,
                           const double pthre_inter, const double pthre_enrich,
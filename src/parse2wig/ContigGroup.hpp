@@ -0,0 +1,58 @@
+/* Copyright(c)  Ryuichiro Nakato <rnakato@iqb.u-tokyo.ac.jp>
+ * All rights reserved.
+ */
+#ifndef _CONTIGGROUP_HPP_
+#define _CONTIGGROUP_HPP_
+
+#include <vector>
+#include <string>
+
+/* Work unit of consecutive chromosomes.
+ * For draft assemblies with many small contigs, the contigs are processed (and reported)
+ * together so that the per-chromosome overhead does not dominate. */
+class ContigGroup {
+  enum {LEN_GROUP=10000000};  // 10 Mbp
+
+public:
+  int32_t s;  // first chromosome id
+  int32_t e;  // last chromosome id (inclusive)
+  ContigGroup(const int32_t _s, const int32_t _e): s(_s), e(_e) {}
+
+  int32_t size() const { return e - s +1; }
+
+  template <class T>
+  std::string getlabel(const std::vector<T> &chr) const {
+    if (s == e) return "chr" + chr[s].getname();
+    return "chr" + chr[s].getname() + "-chr" + chr[e].getname() + " (" + std::to_string(size()) + " contigs)";
+  }
+
+  /* chromosomes >= LEN_GROUP are units by themselves,
+     and the smaller ones are merged until the total length reaches LEN_GROUP */
+  template <class T>
+  static std::vector<ContigGroup> getGroups(const std::vector<T> &chr, const int32_t s, const int32_t e) {
+    std::vector<ContigGroup> vgroup;
+    int32_t start(s);
+    int64_t len(0);
+    for (int32_t i=s; i<=e; ++i) {
+      if (chr[i].getlen() >= LEN_GROUP && i > start) {
+        vgroup.emplace_back(start, i-1);
+        start = i;
+        len = 0;
+      }
+      len += chr[i].getlen();
+      if (len >= LEN_GROUP || i == e) {
+        vgroup.emplace_back(start, i);
+        start = i+1;
+        len = 0;
+      }
+    }
+    return vgroup;
+  }
+  template <class T>
+  static std::vector<ContigGroup> getGroups(const std::vector<T> &chr) {
+    if (chr.empty()) return std::vector<ContigGroup>();
+    return getGroups(chr, 0, chr.size() -1);
+  }
+};
+
+#endif /* _CONTIGGROUP_HPP_ */
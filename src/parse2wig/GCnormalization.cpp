@@ -1,8 +1,13 @@
 /* Copyright(c)  Ryuichiro Nakato <rnakato@iqb.u-tokyo.ac.jp>
  * All rights reserved.
  */
+#include <unordered_map>
+#include <boost/filesystem.hpp>
 #include "GCnormalization.hpp"
 #include "ReadMpbldata.hpp"
+#include "SharedReference.hpp"
+#include "SplitReference.hpp"
+#include "ContigGroup.hpp"
 #include "SeqStatsDROMPA.hpp"
 #include "../submodules/SSP/common/util.hpp"
 
@@ -13,13 +18,13 @@ namespace {
 
   std::vector<int> makeDistGenome(const std::vector<short> &FastaArray,
 				  const std::vector<BpStatus> &mparray,
-				  const int32_t chrlen,
+				  const int64_t chrlen,
 				  const int32_t flen4gc)
   {
     std::vector<int32_t> array(flen4gc+1, 0);
 
-    int32_t end = chrlen - lenIgnoreOfFragment - flen4gc;
-    for (int32_t i= lenIgnoreOfFragment + flen4gc; i<end; ++i) {
+    int64_t end = chrlen - lenIgnoreOfFragment - flen4gc;
+    for (int64_t i= lenIgnoreOfFragment + flen4gc; i<end; ++i) {
       if (mparray[i] != BpStatus::UNMAPPABLE) {
 	int32_t gc(FastaArray[i]);
 	if (gc != -1) array[gc]++;
@@ -31,16 +36,16 @@ namespace {
   std::vector<int> makeDistRead(const std::vector<short> &fastaGCarray,
 				const std::vector<BpStatus> &mparray,
 				const SeqStats &chr,
-				const int32_t chrlen,
+				const int64_t chrlen,
 				const int32_t flen,
 				const int32_t flen4gc)
   {
-    int32_t posi;
+    int64_t posi;
     std::vector<int32_t> array(flen4gc+1, 0);
     for (auto strand: {Strand::FWD, Strand::REV}) {
       for (auto &x: chr.getvReadref(strand)) {
 	if (x.duplicate) continue;
-	if (strand==Strand::FWD) posi = std::min(x.F3 + lenIgnoreOfFragment, chrlen -1);
+	if (strand==Strand::FWD) posi = std::min(static_cast<int64_t>(x.F3 + lenIgnoreOfFragment), chrlen -1);
 	else                     posi = std::max(x.F3 - flen + lenIgnoreOfFragment, 0);
 	if (mparray[posi] == BpStatus::UNMAPPABLE ||
 	    mparray[posi + flen4gc] == BpStatus::UNMAPPABLE) continue;
@@ -51,17 +56,37 @@ namespace {
     return array;
   }
 
-  /* return -1 when including Ns */
-  std::vector<short> makeFastaArray(const std::string &filename,
-				    const int32_t length,
-				    const int32_t flen4gc)
+  /* character source over a FASTA file kept in memory by SharedReference */
+  class SharedFastaStream {
+    const std::string &str;
+    size_t i;
+    bool end;
+
+  public:
+    SharedFastaStream(const std::string &s, const size_t offset): str(s), i(offset), end(false) {}
+    char get() {
+      if (i >= str.size()) {
+        end = true;
+        return std::char_traits<char>::eof();
+      }
+      return str[i++];
+    }
+    bool eof() const { return end; }
+  };
+
+  /* return -1 when including Ns.
+     skip: bases before a part of a split chromosome, whose array ends at length */
+  template <class T>
+  std::vector<short> parseFastaArray(T &in,
+				    const int64_t length,
+				    const int32_t flen4gc,
+				    int64_t skip,
+				    const bool ispart)
   {
-    int32_t s,e, n(0);
+    int64_t s,e, n(0);
     int32_t state(0);
     char c;
     std::vector<short> array(length,0);
-    std::ifstream in(filename);
-    if (!in) PRINTERR_AND_EXIT("Could not open " << filename << ".");
 
     while (!in.eof()) {
       c = in.get();
@@ -75,21 +100,26 @@ namespace {
       case 2:    /*body*/
 	if (c=='>') goto final;
 	else if (isalpha((int)c)) {
+	  if (skip) {
+	    --skip;
+	    break;
+	  }
 	  if (c=='G' || c=='C' || c=='g' || c=='c') {
-	    s = std::max(0, n - flen4gc);
+	    s = std::max(static_cast<int64_t>(0), n - flen4gc);
 	    e = n;
-	    for (int32_t i=s; i<e; i++){
+	    for (int64_t i=s; i<e; i++){
 	      if (array[i] != -1) array[i]++;
 	    }
 	  }else if (c=='A' || c=='T' || c=='a' || c=='t') {
 	    /* none */
 	  }else{  /* N and others */
-	    s = std::max(0, n - flen4gc);
+	    s = std::max(static_cast<int64_t>(0), n - flen4gc);
 	    e = n;
-	    for (int32_t i=s; i<e; i++) array[i] = -1;
+	    for (int64_t i=s; i<e; i++) array[i] = -1;
 	  }
 
 	  n++;
+	  if (ispart && n == length) goto final;
 	  if (n > length) PRINTERR_AND_EXIT("ERROR: length " << length << " < " << n);
 	}
 	break;
@@ -99,6 +129,69 @@ namespace {
   final:
     return array;
   }
+
+  /* offsets of the header lines in a multi-FASTA file, made in one pass at the first request */
+  class MultiFastaIndex {
+    boost::mutex mtx;
+    std::unordered_map<std::string, std::unordered_map<std::string, int64_t>> mp;
+
+    static std::unordered_map<std::string, int64_t> makeIndex(const std::string &filename) {
+      std::unordered_map<std::string, int64_t> index;
+      std::ifstream in(filename);
+      if (!in) PRINTERR_AND_EXIT("Could not open " << filename << ".");
+
+      std::string lineStr;
+      int64_t offset(0);
+      while (getline(in, lineStr)) {
+        if (!lineStr.empty() && lineStr[0] == '>') {
+          std::string name(lineStr.substr(1, lineStr.find_first_of(" \t\r") -1));
+          index[rmchr(name)] = offset;
+        }
+        offset += lineStr.size() +1;
+      }
+      return index;
+    }
+
+  public:
+    int64_t getOffset(const std::string &filename, const std::string &chrname) {
+      boost::mutex::scoped_lock lock(mtx);
+      auto itr = mp.find(filename);
+      if (itr == mp.end()) itr = mp.emplace(filename, makeIndex(filename)).first;
+      auto pos = itr->second.find(rmchr(chrname));
+      if (pos == itr->second.end()) PRINTERR_AND_EXIT("chr" << chrname << " is not in " << filename << ".");
+      return pos->second;
+    }
+  };
+  MultiFastaIndex multiFastaIndex;
+
+  /* GCdir is the directory of chr*.fa or a multi-FASTA file of all chromosomes */
+  std::vector<short> makeFastaArray(const std::string &GCdir,
+                                    const std::string &chrname,
+				    const int64_t length,
+				    const int32_t flen4gc)
+  {
+    // a part of a split chromosome is read from the sequence of the chromosome
+    auto part = SplitReference::getPart(chrname);
+    std::string name(part ? rmchr(part->refname) : chrname);
+    int64_t skip(part ? part->base : 0);
+
+    std::string filename(GCdir + "/chr" + name + ".fa");
+    int64_t offset(0);
+    if (boost::filesystem::is_regular_file(GCdir)) {
+      filename = GCdir;
+      offset = multiFastaIndex.getOffset(filename, name);
+    }
+
+    if (SharedReference::isActive()) {
+      SharedFastaStream in(SharedReference::getFileContent(filename), offset);
+      return parseFastaArray(in, length, flen4gc, skip, part != nullptr);
+    }
+
+    std::ifstream in(filename);
+    if (!in) PRINTERR_AND_EXIT("Could not open " << filename << ".");
+    in.seekg(offset);
+    return parseFastaArray(in, length, flen4gc, skip, part != nullptr);
+  }
 }
 
 
@@ -119,8 +212,7 @@ namespace {
     auto mparray = readMpblBpArray(mpdir, ("chr" + chr.getname()), chr.getlen(), binsize);
     if (isBedOn) setPeak_to_MpblBpArray(mparray, chr.getname(), vbed);
 
-    std::string fastaname = gc.getGCdir() + "/chr" + chr.getname() + ".fa";
-    auto FastaArray = makeFastaArray(fastaname, chr.getlen(), flen4gc);
+    auto FastaArray = makeFastaArray(gc.getGCdir(), chr.getname(), chr.getlen(), flen4gc);
 
     DistGenome = makeDistGenome(FastaArray, mparray, chr.getlen(), flen4gc);
     DistRead = makeDistRead(FastaArray, mparray, chr, chr.getlen(), flen, flen4gc);
@@ -162,21 +254,23 @@ namespace {
 		     boost::mutex &mtx)
   {
     int32_t flen(dist.getflen());
-    for (int32_t i=s; i<=e; ++i) {
-      int32_t posi;
-      std::cout << genome.chr[i].getname() << ".." << std::flush;
-      std::string fa = GCdir + "/chr" + genome.chr[i].getname() + ".fa";
-      auto FastaArray = makeFastaArray(fa, genome.chr[i].getlen(), dist.getflen4gc());
-
-      for (auto strand: {Strand::FWD, Strand::REV}) {
-	for (auto &x: genome.chr[i].getvReadref_notconst(strand)) {
-	  if (x.duplicate) continue;
-	  if (strand==Strand::FWD) posi = std::min(x.F3 + lenIgnoreOfFragment, (int)genome.chr[i].getlen() -1);
-	  else                    posi = std::max(x.F3 - flen + lenIgnoreOfFragment, 0);
-	  int32_t gc(FastaArray[posi]);
-	  if (gc != -1) x.multiplyWeight(dist.getGCweight(gc));
-
-	  genome.chr[i].addReadAfterGC(strand, x.getWeight(), mtx);
+    for (auto &group: ContigGroup::getGroups(genome.chr, s, e)) {
+      std::cout << group.getlabel(genome.chr) << ".." << std::flush;
+      for (int32_t i=group.s; i<=group.e; ++i) {
+        if (!genome.chr[i].getnread_nonred(Strand::BOTH)) continue;  // no need to read the sequence
+	int64_t posi;
+	auto FastaArray = makeFastaArray(GCdir, genome.chr[i].getname(), genome.chr[i].getlen(), dist.getflen4gc());
+
+	for (auto strand: {Strand::FWD, Strand::REV}) {
+	  for (auto &x: genome.chr[i].getvReadref_notconst(strand)) {
+	    if (x.duplicate) continue;
+	    if (strand==Strand::FWD) posi = std::min(static_cast<int64_t>(x.F3 + lenIgnoreOfFragment), static_cast<int64_t>(genome.chr[i].getlen()) -1);
+	    else                    posi = std::max(x.F3 - flen + lenIgnoreOfFragment, 0);
+	    int32_t gc(FastaArray[posi]);
+	    if (gc != -1) x.multiplyWeight(dist.getGCweight(gc));
+
+	    genome.chr[i].addReadAfterGC(strand, x.getWeight(), mtx);
+	  }
 	}
       }
     }
@@ -30,7 +30,7 @@ public:
   {
     opt.add_options()
       ("chrdir", boost::program_options::value<std::string>(),
-       "Chromosome directory of reference genome sequence for GC content estimation")
+       "Chromosome directory (or a multi-FASTA file) of reference genome sequence for GC content estimation")
       ("flen4gc",
        boost::program_options::value<int32_t>()->default_value(120)->notifier(std::bind(&MyOpt::over<int32_t>, std::placeholders::_1, 0, "--flen4gc")),
        "Fragment length for calculation of GC distribution")
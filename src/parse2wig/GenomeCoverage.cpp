@@ -8,11 +8,13 @@
 #include "../submodules/SSP/src/SeqStats.hpp"
 
 namespace GenomeCov {
-  std::vector<BpStatus> makeGcovArray(const Mapfile &p, const SeqStats &chr, const double r4cmp)
+  void makeGcovArray(const Mapfile &p, const SeqStats &chr, const double r4cmp, std::mt19937 &mt,
+                     std::vector<BpStatus> &array)
   {
-    int32_t chrlen(chr.getlen());
+    int64_t chrlen(chr.getlen());
+    std::uniform_int_distribution<int32_t> dist(0, RAND_MAX);
 
-    auto array = readMpblBpArray(p.getMpblBinaryDir(), ("chr" + chr.getname()), chrlen, p.wsGenome.getbinsize());
+    readMpblBpArray(p.getMpblBinaryDir(), ("chr" + chr.getname()), chrlen, p.wsGenome.getbinsize(), array);
     if(p.isBedOn()) setPeak_to_MpblBpArray(array, chr.getname(), p.getvbedref());
 
     for (auto strand: {Strand::FWD, Strand::REV}) {
@@ -20,20 +22,19 @@ namespace GenomeCov {
 	if (x.duplicate) continue;
 
 	BpStatus val;
-	if(rand() >= r4cmp) val = BpStatus::COVREAD_ALL;
+	if(dist(mt) >= r4cmp) val = BpStatus::COVREAD_ALL;
 	else                val = BpStatus::COVREAD_NORM;
 
-	int32_t s(std::max(0, std::min(x.F3, x.F5)));
-	int32_t e(std::min(std::max(x.F3, x.F5), chrlen-1));
+	int64_t s(std::max(0, std::min(x.F3, x.F5)));
+	int64_t e(std::min(static_cast<int64_t>(std::max(x.F3, x.F5)), chrlen-1));
 	//	std::cout << static_cast<int>(val) << "\t"<< x.F3<< "\t"<< x.F5<< "\t"<< s<< "\t"<< e<<std::endl;
 	if (s >= chrlen || e < 0) {
 	  std::cerr << "Warning: " << chr.getname() << " read " << s <<"-"<< e << " > array size " << chr.getlen() << std::endl;
 	}
-	for (int32_t i=s; i<=e; ++i) {
+	for (int64_t i=s; i<=e; ++i) {
 	  if (array[i]==BpStatus::MAPPABLE) array[i] = val;
 	}
       }
     }
-    return array;
   }
 }
@@ -7,6 +7,7 @@
 #include <iostream>
 #include <fstream>
 #include <stdint.h>
+#include <random>
 #include <boost/format.hpp>
 #include "BpStatus.hpp"
 #include "../submodules/SSP/common/inline.hpp"
@@ -15,7 +16,8 @@ class SeqStats;
 class Mapfile;
 
 namespace GenomeCov {
-  std::vector<BpStatus> makeGcovArray(const Mapfile &, const SeqStats &chr, const double r4cmp);
+  void makeGcovArray(const Mapfile &, const SeqStats &chr, const double r4cmp, std::mt19937 &mt,
+                     std::vector<BpStatus> &array);
 
   class gvStats {
     virtual uint64_t getnbp() const = 0;
@@ -58,6 +60,11 @@ namespace GenomeCov {
       }
     }
 
+    /* chromosome without reads: only the mappable length is needed */
+    Chr(const uint64_t lenmpbl, const bool b):
+      gvStats(b), nbp(lenmpbl), ncov(0), ncovnorm(0)
+    {}
+
     uint64_t getnbp()       const { return nbp; }
     uint64_t getncov()      const { return ncov; }
     uint64_t getncovnorm()  const { return ncovnorm; }
@@ -65,6 +72,7 @@ namespace GenomeCov {
 
   class Genome: public gvStats {
     enum { numGcov=5000000 };
+    enum { seed=1 };
     double r4cmp;
 
   public:
@@ -82,6 +90,8 @@ namespace GenomeCov {
     }
 
     double getr4cmp() const { return r4cmp; }
+    /* a fixed seed per sample keeps the stats identical between single and --batch runs */
+    std::mt19937 getRandomGenerator() const { return std::mt19937(seed); }
     bool getlackOfRead() const { return lackOfRead; }
 
     uint64_t getnbp() const {
@@ -0,0 +1,125 @@
+/* Copyright(c)  Ryuichiro Nakato <rnakato@iqb.u-tokyo.ac.jp>
+ * All rights reserved.
+ */
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/format.hpp>
+#include "ReadFilter.hpp"
+#include "SpikeIn.hpp"
+#include "SplitReference.hpp"
+#include "../submodules/SSP/src/SeqStats.hpp"
+
+namespace {
+  inline uint64_t splitmix64(uint64_t z)
+  {
+    z += 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+}
+
+double getReadRandom(const ReadRandom stream, const uint64_t seed,
+                     const uint64_t chrid, const uint64_t strand, const uint64_t i)
+{
+  // each field is mixed in turn so that no field can overlap another
+  uint64_t z(splitmix64(static_cast<uint64_t>(stream)));
+  for (auto x: {seed, chrid, strand, i}) z = splitmix64(z ^ x);
+  return (z >> 11) * (1.0 / (1ULL << 53));
+}
+
+namespace {
+  void downsampleChromosomes(SeqStatsGenomeSSP &genome, const int32_t s, const int32_t e,
+                             const double ratio, const int32_t seed)
+  {
+    for (int32_t i=s; i<=e; ++i) {
+      for (auto strand: {Strand::FWD, Strand::REV}) {
+        auto &vRead = genome.chr[i].getvReadref_notconst(strand);
+        size_t n(0);
+        uint64_t nred(0);
+        for (size_t j=0; j<vRead.size(); ++j) {
+          if (getReadRandom(ReadRandom::DOWNSAMPLE, seed, i, strand, j) >= ratio) continue;
+          if (vRead[j].duplicate) ++nred;
+          vRead[n++] = vRead[j];
+        }
+        vRead.resize(n);
+        vRead.shrink_to_fit();
+
+        auto &seq = genome.chr[i].seq[strand];
+        seq.nread        = n;
+        seq.nread_red    = nred;
+        seq.nread_nonred = n - nred;
+      }
+    }
+  }
+
+  void filterBlacklistChromosomes(SeqStatsGenomeSSP &genome, const int32_t s, const int32_t e,
+                                  const BedIndex &index, std::vector<uint64_t> &nread_excluded)
+  {
+    for (int32_t i=s; i<=e; ++i) {
+      // the reads of a part of a split chromosome are at base + offset of the chromosome
+      auto part = SplitReference::getPart(genome.chr[i].getname());
+      int64_t base(part ? part->base : 0);
+      auto &vbl = index.getIntervals(part ? rmchr(part->refname) : genome.chr[i].getname());
+      if (vbl.empty()) continue;
+
+      for (auto strand: {Strand::FWD, Strand::REV}) {
+        auto &vRead = genome.chr[i].getvReadref_notconst(strand);
+        size_t n(0);
+        for (size_t j=0; j<vRead.size(); ++j) {
+          if (BedIndex::contains(vbl, base + vRead[j].F3)) continue;
+          vRead[n++] = vRead[j];
+        }
+        nread_excluded[i] += vRead.size() - n;
+        vRead.resize(n);
+        vRead.shrink_to_fit();
+        genome.chr[i].seq[strand].nread = n;
+      }
+    }
+  }
+}
+
+void Downsampling::downsample(SeqStatsGenomeSSP &genome, const SpikeIn &spikein)
+{
+  DEBUGprint_FUNCStart();
+
+  nread_before = genome.getnread_nonred(Strand::BOTH) - spikein.getnread_nonred(genome);
+  ratio = fraction ? fraction : getratio(ntarget, nread_before);
+  if (ratio >= 1) {
+    std::cout << boost::format("Downsampling skipped: nonredundant reads (%1%) <= %2%\n") % nread_before % ntarget;
+    ratio = 1;
+    nread_after = nread_before;
+    return;
+  }
+
+  boost::thread_group agroup;
+  for (auto &x: genome.vsepchr) {
+    agroup.create_thread(boost::bind(downsampleChromosomes, boost::ref(genome), x.s, x.e, ratio, seed));
+  }
+  agroup.join_all();
+
+  nread_after = genome.getnread_nonred(Strand::BOTH) - spikein.getnread_nonred(genome);
+  std::cout << boost::format("Downsampling: %1$.4f, nonredundant reads %2% -> %3%\n") % ratio % nread_before % nread_after;
+
+  DEBUGprint_FUNCend();
+  return;
+}
+
+void Blacklist::filter(SeqStatsGenomeSSP &genome)
+{
+  DEBUGprint_FUNCStart();
+
+  nread_excluded.assign(genome.chr.size(), 0);
+
+  boost::thread_group agroup;
+  for (auto &x: genome.vsepchr) {
+    agroup.create_thread(boost::bind(filterBlacklistChromosomes, boost::ref(genome), x.s, x.e,
+                                     boost::cref(index), boost::ref(nread_excluded)));
+  }
+  agroup.join_all();
+
+  std::cout << "Reads in blacklist: " << getnread_excluded() << std::endl;
+
+  DEBUGprint_FUNCend();
+  return;
+}
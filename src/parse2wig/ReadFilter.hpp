@@ -0,0 +1,127 @@
+/* Copyright(c)  Ryuichiro Nakato <rnakato@iqb.u-tokyo.ac.jp>
+ * All rights reserved.
+ */
+#ifndef _READFILTER_HPP_
+#define _READFILTER_HPP_
+
+#include <fstream>
+#include <boost/format.hpp>
+#include "../submodules/SSP/common/BoostOptions.hpp"
+#include "../submodules/SSP/common/inline.hpp"
+#include "BedIndex.hpp"
+
+class SeqStatsGenomeSSP;
+class SpikeIn;
+
+/* independent random streams of the read sampling steps */
+enum class ReadRandom {COMPLEXITY=1, DOWNSAMPLE=2};
+
+/* Pseudo-random number in [0, 1) determined by the read index,
+ * so that read sampling does not depend on the thread scheduling. */
+double getReadRandom(const ReadRandom stream, const uint64_t seed,
+                     const uint64_t chrid, const uint64_t strand, const uint64_t i);
+
+/* Downsampling of the reads after the redundant read check (--downsample).
+ * The redundant flags are kept and the read numbers are recounted.
+ * Spike-in reads are sampled at the same ratio but not counted for the target number. */
+class Downsampling {
+  MyOpt::Opts opt;
+  double fraction;
+  uint64_t ntarget;
+  int32_t seed;
+
+  double ratio;
+  uint64_t nread_before;
+  uint64_t nread_after;
+
+public:
+  Downsampling():
+    opt("Downsampling",100),
+    fraction(0), ntarget(0), seed(0),
+    ratio(1), nread_before(0), nread_after(0)
+  {
+    opt.add_options()
+      ("downsample", boost::program_options::value<double>(),
+       "Downsample the nonredundant reads to this number (>= 1) or fraction (< 1)")
+      ("downsample_seed",
+       boost::program_options::value<int32_t>()->default_value(0),
+       "(for --downsample) random seed")
+      ;
+  }
+
+  void setOpts(MyOpt::Opts &allopts) {
+    allopts.add(opt);
+  }
+  void setValues(const MyOpt::Variables &values) {
+    if (values.count("downsample")) {
+      double v(MyOpt::getVal<double>(values, "downsample"));
+      if (v <= 0) PRINTERR_AND_EXIT("--downsample should be positive.");
+      if (v < 1) fraction = v;
+      else ntarget = v;
+    }
+    seed = MyOpt::getVal<int32_t>(values, "downsample_seed");
+  }
+  void dump() const {
+    if (fraction) std::cout << "Downsampling: " << fraction << " of nonredundant reads" << std::endl;
+    if (ntarget)  std::cout << "Downsampling: " << ntarget << " nonredundant reads" << std::endl;
+  }
+
+  bool isOn() const { return fraction || ntarget; }
+  void downsample(SeqStatsGenomeSSP &genome, const SpikeIn &spikein);
+  void print(std::ofstream &out) const {
+    if (!isOn()) return;
+    out << boost::format("Downsampling: %1$.4f (nonredundant reads %2% -> %3%)\n") % ratio % nread_before % nread_after;
+  }
+};
+
+/* Removal of the reads whose 5' end is in the blacklist regions (--blacklist).
+ * Applied just after reading the input, so that all read numbers (including the total
+ * read number for normalization) reflect the filtered reads. */
+class Blacklist {
+  MyOpt::Opts opt;
+  std::string filename;
+  BedIndex index;
+
+  std::vector<uint64_t> nread_excluded;
+
+public:
+  Blacklist():
+    opt("Blacklist",100),
+    filename("")
+  {
+    opt.add_options()
+      ("blacklist", boost::program_options::value<std::string>(),
+       "BED file of blacklist regions. Reads whose 5' end is in these regions are excluded")
+      ;
+  }
+
+  void setOpts(MyOpt::Opts &allopts) {
+    allopts.add(opt);
+  }
+  void setValues(const MyOpt::Variables &values) {
+    if (!values.count("blacklist")) return;
+    filename = MyOpt::getVal<std::string>(values, "blacklist");
+    isFile(filename);
+    index = BedIndex(filename);
+  }
+  void dump() const {
+    if (isOn()) std::cout << boost::format("Blacklist: %1% (%2% regions, %3% bp)\n") % filename % index.size() % index.getlen();
+  }
+
+  bool isOn() const { return filename != ""; }
+  void filter(SeqStatsGenomeSSP &genome);
+
+  uint64_t getnread_excluded() const {
+    uint64_t n(0);
+    for (auto x: nread_excluded) n += x;
+    return n;
+  }
+  uint64_t getnread_excluded(const int32_t id) const { return nread_excluded[id]; }
+  void print(std::ofstream &out, const uint64_t nread) const {
+    if (!isOn()) return;
+    uint64_t n(getnread_excluded());
+    out << boost::format("Reads in blacklist: %1% (%2$.1f%%)\n") % n % getpercent(n, n + nread);
+  }
+};
+
+#endif /* _READFILTER_HPP_ */
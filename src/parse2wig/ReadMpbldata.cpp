@@ -4,11 +4,41 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <algorithm>
 #include <boost/filesystem.hpp>
 #include "ReadMpbldata.hpp"
+#include "SharedReference.hpp"
+#include "GzipReader.hpp"
+#include "SplitReference.hpp"
 #include "../submodules/SSP/common/seq.hpp"
 #include "../submodules/SSP/src/SeqStats.hpp"
-#include "../submodules/SSP/common/gzstream.h"
+
+namespace {
+  /* offset: the first bin (of a part of a split chromosome) */
+  std::vector<int32_t> parseMpblWigArray(const std::string &filename,
+                                         const int32_t binsize,
+                                         const int32_t nbin,
+                                         const int64_t offset)
+  {
+    std::vector<int32_t> mparray(nbin, 0);
+
+    // the binned wig is bounded by the bin number (MPBLWIG_BYTES_PER_BIN in ResourcePlan), so it is decoded at once
+    std::string data(readGzipFile(filename));
+    const char *p(data.c_str());
+    while (*p) {
+      char *end;
+      int64_t pos(strtoll(p, &end, 10));
+      if (end != p) {
+        int64_t i(pos/binsize - offset);
+        if (i >= 0 && i < nbin) mparray[i] = strtod(end, &end);
+      }
+      p = end;
+      while (*p && *p != '\n') ++p;
+      if (*p) ++p;
+    }
+    return mparray;
+  }
+}
 
 std::vector<int32_t> readMpblWigArray(const std::string &mpfile,
 				      const std::string &chrname,
@@ -16,22 +46,28 @@ std::vector<int32_t> readMpblWigArray(const std::string &mpfile,
 				      const int32_t nbin)
 {
   DEBUGprint_FUNCStart();
-  std::string filename = mpfile + "/map_" + chrname + "." + std::to_string(binsize) + ".wig.gz";
-  std::vector<int32_t> mparray(nbin, 0);
+  // a part of a split chromosome takes its bins from the wig of the chromosome
+  std::string name(chrname);
+  int64_t offset(0);
+  auto part = SplitReference::getPart(chrname);
+  if (part) {
+    name = "chr" + rmchr(part->refname);
+    offset = part->base / binsize;
+    prepareMpblWigData(mpfile, name, part->reflen, binsize);
+  }
+  std::string filename = mpfile + "/map_" + name + "." + std::to_string(binsize) + ".wig.gz";
 
   DEBUGprint("mpfile: " << filename);
 
-  igzstream in(filename.c_str());
-
-  std::string lineStr;
-  while (!in.eof()) {
-    getline(in, lineStr);
-    if(lineStr.empty()) continue;
-    std::vector<std::string> v;
-    ParseLine(v, lineStr, '\t');
-    mparray[(stoi(v[0]))/binsize] = stod(v[1]);
+  if (SharedReference::isActive()) {
+    auto &mparray = SharedReference::getMpblWigArray(filename + ":" + std::to_string(offset),
+                                                     [&](){ return parseMpblWigArray(filename, binsize, nbin, offset); });
+    DEBUGprint_FUNCend();
+    return mparray;
   }
 
+  auto mparray = parseMpblWigArray(filename, binsize, nbin, offset);
+
   DEBUGprint_FUNCend();
   return mparray;
 }
@@ -42,14 +78,14 @@ namespace {
     std::cout << filename << ".gz not found. Generating.." << std::endl;
 
     FILE* File = fopen(filename.c_str(), "w");
-    int32_t nbin(mparray.size()/binsize +1);
+    int64_t nbin(mparray.size()/binsize +1);
     std::vector<int32_t> wigarray(nbin, 0);
 
     for (size_t i=0; i<mparray.size(); ++i) {
       if (mparray[i] == BpStatus::MAPPABLE) ++wigarray[i/binsize];
     }
-    for (int32_t i=0; i<nbin; ++i) {
-      fprintf(File, "%d\t%.4f\n", i*binsize, wigarray[i]/(double)binsize);
+    for (int64_t i=0; i<nbin; ++i) {
+      fprintf(File, "%ld\t%.4f\n", i*binsize, wigarray[i]/(double)binsize);
     }
     fclose(File);
 
@@ -60,64 +96,124 @@ namespace {
 }
 
 
+namespace {
+  void parseMpblBpArray(const std::string &mpfile,
+                        const std::string &chrname,
+                        const int64_t chrlen,
+                        const int32_t binsize,
+                        std::vector<BpStatus> &mparray)
+  {
+    mparray.assign(chrlen, BpStatus::UNMAPPABLE);
+
+    // a part of a split chromosome takes [base, base + chrlen) of the chromosome
+    auto part = SplitReference::getPart(chrname);
+    std::string name(part ? "chr" + rmchr(part->refname) : chrname);
+    int64_t skip(part ? part->base : 0);
+    int64_t end(part && !part->islast() ? chrlen : chrlen-1);
+
+    std::string filename = mpfile + "/map_" + name + "_binary.txt.gz";
+    isFile(filename);
+
+    // decoded in chunks, so that the file (about chrlen bytes) is not held in memory with the array
+    GzipStream in(filename);
+    std::vector<char> buf(1<<20);
+    int64_t n(-skip);
+    while (n < end) {
+      in.read(buf.data(), buf.size());
+      std::streamsize nbuf(in.gcount());
+      if (!nbuf) break;
+      for (std::streamsize i=0; i<nbuf && n < end; ++i) {
+        if(buf[i]==' ') continue;
+        if(buf[i]=='1' && n >= 0) mparray[n] = BpStatus::MAPPABLE;
+        ++n;
+      }
+    }
+    // the wig of a split chromosome is generated from the whole chromosome (readMpblWigArray)
+    if (part) return;
+
+    std::string mpblwigfile = mpfile + "/map_" + chrname + "." + std::to_string(binsize) + ".wig";
+    boost::filesystem::path const file(mpblwigfile + ".gz");
+    if(!boost::filesystem::exists(file)) {
+      generateMpblWigData(mpblwigfile, mparray, binsize);
+    }
+  }
+}
+
 std::vector<BpStatus> readMpblBpArray(const std::string &mpfile,
 				      const std::string &chrname,
-				      const int32_t chrlen,
+				      const int64_t chrlen,
 				      const int32_t binsize)
 {
-  static int32_t on(0);
+  std::vector<BpStatus> mparray;
+  readMpblBpArray(mpfile, chrname, chrlen, binsize, mparray);
+  return mparray;
+}
 
+/* mparray is overwritten, so that a buffer can be reused for the chromosomes */
+void readMpblBpArray(const std::string &mpfile,
+                     const std::string &chrname,
+                     const int64_t chrlen,
+                     const int32_t binsize,
+                     std::vector<BpStatus> &mparray)
+{
   if(mpfile == "") {
-    if(!on) {
-      std::cout << "Mappability file is not specified. All genomeic regions are considered as mappable." << std::endl;
-      on=1;
-    }
-    return std::vector<BpStatus>(chrlen, BpStatus::MAPPABLE);
+    mparray.assign(chrlen, BpStatus::MAPPABLE);
+    return;
   }
 
-  if(!on) {
-    std::cout << "Reading binary mappability file.." << std::flush;
-    on=1;
+  if (SharedReference::isActive()) {
+    // the mappable regions are kept as runs and expanded for each sample
+    std::string key = mpfile + "/map_" + chrname + "_binary.txt.gz:" + std::to_string(binsize);
+    auto &runs = SharedReference::getMpblRuns(key, [&](){
+        std::vector<BpStatus> array;
+        parseMpblBpArray(mpfile, chrname, chrlen, binsize, array);
+        return array;
+      });
+    mparray.assign(chrlen, BpStatus::UNMAPPABLE);
+    for (auto &x: runs) std::fill(mparray.begin() + x.start, mparray.begin() + x.end, BpStatus::MAPPABLE);
+    return;
   }
-  std::vector<BpStatus> mparray(chrlen, BpStatus::UNMAPPABLE);
-
-  std::string filename = mpfile + "/map_" + chrname + "_binary.txt.gz";
-  isFile(filename);
 
-  igzstream in(filename.c_str());
+  parseMpblBpArray(mpfile, chrname, chrlen, binsize, mparray);
+}
 
-  int32_t n(0);
-  int8_t c;
-  while (!in.eof()) {
-    c = in.get();
-    if(c==' ') continue;
-    if(c=='1') mparray[n] = BpStatus::MAPPABLE;
-    ++n;
-    if(n >= chrlen-1) break;
+/* generates the binned mappability wig from the binary file if it does not exist yet,
+   so that concurrent samples in --batch mode do not write the same file */
+void prepareMpblWigData(const std::string &mpfile,
+                        const std::string &chrname,
+                        const int64_t chrlen,
+                        const int32_t binsize)
+{
+  if(mpfile == "") return;
+  auto part = SplitReference::getPart(chrname);
+  if (part) {
+    prepareMpblWigData(mpfile, "chr" + rmchr(part->refname), part->reflen, binsize);
+    return;
   }
-
   std::string mpblwigfile = mpfile + "/map_" + chrname + "." + std::to_string(binsize) + ".wig";
-  boost::filesystem::path const file(mpblwigfile + ".gz");
-  if(!boost::filesystem::exists(file)) {
-    generateMpblWigData(mpblwigfile, mparray, binsize);
-  }
-
-  return mparray;
+  if(boost::filesystem::exists(mpblwigfile + ".gz")) return;
+  std::vector<BpStatus> mparray;
+  parseMpblBpArray(mpfile, chrname, chrlen, binsize, mparray);
 }
 
 void setPeak_to_MpblBpArray(std::vector<BpStatus> &array,
 			    const std::string &chrname,
 			    const std::vector<bed> &vbed)
 {
-  int32_t chrlen(array.size());
+  int64_t chrlen(array.size());
+
+  // the regions of a split chromosome are shifted to the part
+  auto part = SplitReference::getPart(chrname);
+  std::string name(part ? rmchr(part->refname) : chrname);
+  int64_t base(part ? part->base : 0);
 
   for(auto &bed: vbed) {
-//    std::cout << bed.chr << "?" << chrname << std::endl;
-    if(bed.chr == chrname) {
-      size_t s(std::max(0, bed.start));
-      size_t e(std::min(bed.end, chrlen-1));
+//    std::cout << bed.chr << "?" << name << std::endl;
+    if(bed.chr == name) {
+      int64_t s(std::max(static_cast<int64_t>(0), bed.start - base));
+      int64_t e(std::min(bed.end - base, chrlen-1));
 //      printf("s=%d, e=%d\n", s,e);
-      for(size_t i=s; i<=e; ++i) array[i] = BpStatus::INBED;
+      for(int64_t i=s; i<=e; ++i) array[i] = BpStatus::INBED;
     }
   }
 
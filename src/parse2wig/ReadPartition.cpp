@@ -0,0 +1,89 @@
+/* Copyright(c)  Ryuichiro Nakato <rnakato@iqb.u-tokyo.ac.jp>
+ * All rights reserved.
+ */
+#include <fstream>
+#include <boost/format.hpp>
+#include "ReadPartition.hpp"
+#include "SeqStatsDROMPA.hpp"
+#include "../submodules/SSP/common/util.hpp"
+
+void ReadPartition::setFraglenRange(const std::string &str)
+{
+  std::vector<std::string> v;
+  ParseLine(v, str, ',');
+  for (auto &x: v) {
+    std::vector<std::string> range;
+    ParseLine(range, x, '-');
+    if (range.size() != 2) PRINTERR_AND_EXIT("invalid range in --partition: " << x);
+    int32_t min(0), max(0);
+    try {
+      min = stoi(range[0]);
+      max = stoi(range[1]);
+    } catch (std::exception &e) {
+      PRINTERR_AND_EXIT("invalid range in --partition: " << x);
+    }
+    if (min < 0 || min > max) PRINTERR_AND_EXIT("invalid range in --partition: " << x);
+    for (auto &r: vrange) {
+      if (min <= r.second && r.first <= max) PRINTERR_AND_EXIT("overlapping ranges in --partition: " << x);
+    }
+    vrange.emplace_back(min, max);
+    vlabel.emplace_back("fraglen" + range[0] + "-" + range[1]);
+  }
+}
+
+void ReadPartition::setValues(const MyOpt::Variables &values, const size_t nchr, const bool ispaired)
+{
+  if (!values.count("partition")) return;
+
+  std::string str(MyOpt::getVal<std::string>(values, "partition"));
+  if (str == "strand") {
+    type = Type::STRAND;
+    vlabel = {"fwd", "rev"};
+  } else if (str.find("fraglen:") == 0) {
+    if (!ispaired) PRINTERR_AND_EXIT("--partition fraglen requires paired-end data (--pair).");
+    type = Type::FRAGLEN;
+    setFraglenRange(str.substr(8));
+  } else {
+    PRINTERR_AND_EXIT("invalid --partition: " << str);
+  }
+  if (values.count("bpres")) PRINTERR_AND_EXIT("--partition cannot be used with --bpres.");
+
+  nread.assign(vlabel.size(), std::vector<uint64_t>(nchr, 0));
+}
+
+int32_t ReadPartition::getPartition(const Read &x, const Strand::Strand strand) const
+{
+  if (type == Type::STRAND) return strand == Strand::FWD ? 0 : 1;
+  if (type == Type::FRAGLEN) {
+    int32_t len(std::abs(x.F5 - x.F3) +1);
+    for (size_t i=0; i<vrange.size(); ++i) {
+      if (vrange[i].first <= len && len <= vrange[i].second) return i;
+    }
+  }
+  return -1;
+}
+
+void ReadPartition::outputStats(const std::string &filename, const SeqStatsGenome &genome) const
+{
+  std::ofstream out(filename);
+
+  out << "nonredundant reads\tGenome\t\t";
+  for (auto &x: genome.chr) out << x.getname() << "\t\t";
+  out << std::endl;
+  out << "partition\tnum\t%\t";
+  for (size_t i=0; i<genome.chr.size(); ++i) out << "num\t%\t";
+  out << std::endl;
+
+  for (size_t i=0; i<vlabel.size(); ++i) {
+    out << vlabel[i] << "\t";
+    uint64_t sum(0);
+    for (auto n: nread[i]) sum += n;
+    out << boost::format("%1%\t%2$.1f%%\t") % sum % getpercent(sum, genome.getnread_nonred(Strand::BOTH));
+    for (size_t j=0; j<genome.chr.size(); ++j) {
+      out << boost::format("%1%\t%2$.1f%%\t") % nread[i][j] % getpercent(nread[i][j], genome.chr[j].getnread_nonred(Strand::BOTH));
+    }
+    out << std::endl;
+  }
+
+  std::cout << "partition stats is output in " << filename << "." << std::endl;
+}
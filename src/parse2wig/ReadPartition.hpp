@@ -0,0 +1,73 @@
+/* Copyright(c)  Ryuichiro Nakato <rnakato@iqb.u-tokyo.ac.jp>
+ * All rights reserved.
+ */
+#ifndef _READPARTITION_HPP_
+#define _READPARTITION_HPP_
+
+#include <vector>
+#include <string>
+#include "../submodules/SSP/common/BoostOptions.hpp"
+#include "../submodules/SSP/common/inline.hpp"
+#include "../submodules/SSP/common/seq.hpp"
+#include "WigStats.hpp"
+
+class Read;
+class SeqStatsGenome;
+
+/* Read partition for --partition.
+ * Each read is routed to at most one partition while the wig data of all reads is made,
+ * so that the tracks of all partitions are generated in a single pass. */
+class ReadPartition {
+  enum class Type {NONE, STRAND, FRAGLEN};
+
+  MyOpt::Opts opt;
+  Type type;
+  std::vector<std::pair<int32_t, int32_t>> vrange;  // fragment length ranges (inclusive)
+  std::vector<std::string> vlabel;
+  std::vector<std::vector<uint64_t>> nread;   // [partition][chromosome]
+  std::vector<WigStatsGenome> vwsGenome;      // bin statistics of each partition wig
+
+  void setFraglenRange(const std::string &str);
+
+public:
+  ReadPartition():
+    opt("Read partition",100),
+    type(Type::NONE)
+  {
+    opt.add_options()
+      ("partition", boost::program_options::value<std::string>(),
+       "Output the data of read partitions in addition to all reads:\n   strand: forward and reverse reads\n   fraglen:<min>-<max>,<min>-<max>,...: (for paired-end) fragment length ranges (e.g., fraglen:0-120,150-300)")
+      ;
+  }
+
+  void setOpts(MyOpt::Opts &allopts) {
+    allopts.add(opt);
+  }
+  void setValues(const MyOpt::Variables &values, const size_t nchr, const bool ispaired);
+  void dump() const {
+    if (!isOn()) return;
+    std::cout << "Read partition:";
+    for (auto &x: vlabel) std::cout << " " << x;
+    std::cout << std::endl;
+  }
+
+  bool isOn() const { return type != Type::NONE; }
+  size_t size() const { return vlabel.size(); }
+  const std::string & getlabel(const size_t i) const { return vlabel[i]; }
+
+  /* -1: the read belongs to no partition */
+  int32_t getPartition(const Read &x, const Strand::Strand strand) const;
+  void addRead(const int32_t part, const int32_t chrid) { ++nread[part][chrid]; }
+
+  /* the statistics of each partition are collected as in wsGenome (same bins and excluded chromosomes) */
+  void initWigStats(const WigStatsGenome &wsGenome) { vwsGenome.assign(vlabel.size(), wsGenome); }
+  void setWigStats(const int32_t part, const int32_t chrid, const WigArray &array) {
+    vwsGenome[part].setWigStats(chrid, array);
+  }
+  WigStatsGenome & getWigStats(const size_t i) { return vwsGenome[i]; }
+  const WigStatsGenome & getWigStats(const size_t i) const { return vwsGenome[i]; }
+
+  void outputStats(const std::string &filename, const SeqStatsGenome &genome) const;
+};
+
+#endif /* _READPARTITION_HPP_ */
@@ -0,0 +1,156 @@
+/* Copyright(c)  Ryuichiro Nakato <rnakato@iqb.u-tokyo.ac.jp>
+ * All rights reserved.
+ */
+#include <algorithm>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/format.hpp>
+#include "RedundantReads.hpp"
+#include "ReadFilter.hpp"
+#include "../submodules/SSP/src/SeqStats.hpp"
+
+namespace {
+  class ReadKey {
+  public:
+    uint64_t key;
+    uint32_t id;
+    ReadKey(): key(0), id(0) {}
+    ReadKey(const uint64_t k, const uint32_t i): key(k), id(i) {}
+  };
+
+  uint64_t getKey(const Read &x, const bool paired)
+  {
+    uint64_t key(static_cast<uint32_t>(x.F3));
+    if (paired) key = (key << 32) | static_cast<uint32_t>(x.F5);
+    return key;
+  }
+
+  /* stable LSD radix sort by 16-bit digits, so that reads with the same key keep the input order.
+     Passes in which all keys share the same digit are skipped. */
+  void radixSort(std::vector<ReadKey> &v, const int32_t nbit)
+  {
+    enum {DIGIT=16, NBUCKET=1<<DIGIT};
+    if (v.size() < 2) return;
+
+    std::vector<ReadKey> tmp(v.size());
+    std::vector<size_t> count(NBUCKET);
+    for (int32_t shift=0; shift<nbit; shift+=DIGIT) {
+      std::fill(count.begin(), count.end(), 0);
+      for (auto &x: v) ++count[(x.key >> shift) & (NBUCKET-1)];
+      if (count[(v[0].key >> shift) & (NBUCKET-1)] == v.size()) continue;
+
+      size_t sum(0);
+      for (auto &c: count) {
+        size_t n(c);
+        c = sum;
+        sum += n;
+      }
+      for (auto &x: v) tmp[count[(x.key >> shift) & (NBUCKET-1)]++] = x;
+      v.swap(tmp);
+    }
+  }
+
+  uint64_t markRedundantReads(std::vector<Read> &vRead, const bool paired, const int32_t threshold)
+  {
+    std::vector<ReadKey> v;
+    v.reserve(vRead.size());
+    for (size_t i=0; i<vRead.size(); ++i) v.emplace_back(getKey(vRead[i], paired), i);
+    radixSort(v, paired ? 64 : 32);
+
+    uint64_t nred(0);
+    int32_t n(0);
+    for (size_t i=0; i<v.size(); ++i) {
+      if (!i || v[i].key != v[i-1].key) n = 0;
+      if (++n > threshold) {
+        vRead[v[i].id].duplicate = 1;
+        ++nred;
+      } else {
+        vRead[v[i].id].duplicate = 0;
+      }
+    }
+    return nred;
+  }
+
+  void countNonredundantSampled(const std::vector<Read> &vRead, const bool paired,
+                                const int32_t chrid, const int32_t strand, const double r4cmp,
+                                uint64_t &nsampled, uint64_t &nnonred)
+  {
+    std::vector<ReadKey> v;
+    for (size_t i=0; i<vRead.size(); ++i) {
+      if (getReadRandom(ReadRandom::COMPLEXITY, 0, chrid, strand, i) < r4cmp) v.emplace_back(getKey(vRead[i], paired), i);
+    }
+    radixSort(v, paired ? 64 : 32);
+
+    nsampled += v.size();
+    for (size_t i=0; i<v.size(); ++i) {
+      if (!i || v[i].key != v[i-1].key) ++nnonred;
+    }
+  }
+
+  void filterChromosomes(SeqStatsGenomeSSP &genome, const int32_t s, const int32_t e,
+                         const int32_t threshold, const bool nofilter, const double r4cmp,
+                         std::vector<uint64_t> &vnsampled, std::vector<uint64_t> &vnnonred)
+  {
+    bool paired(genome.isPaired());
+    for (int32_t i=s; i<=e; ++i) {
+      for (auto strand: {Strand::FWD, Strand::REV}) {
+        auto &vRead = genome.chr[i].getvReadref_notconst(strand);
+        uint64_t nred(0);
+        if (nofilter) {
+          for (auto &x: vRead) x.duplicate = 0;
+        } else {
+          nred = markRedundantReads(vRead, paired, threshold);
+        }
+        genome.chr[i].seq[strand].nread_red    = nred;
+        genome.chr[i].seq[strand].nread_nonred = vRead.size() - nred;
+
+        countNonredundantSampled(vRead, paired, i, strand, r4cmp, vnsampled[i], vnnonred[i]);
+      }
+    }
+  }
+}
+
+void RedundantReadFilter::checkRedundantReads(SeqStatsGenomeSSP &genome)
+{
+  DEBUGprint_FUNCStart();
+
+  uint64_t nread(genome.getnread(Strand::BOTH));
+  // default: more than max(1 read, 10 times greater than genome average)
+  if (thre_pb) threshold = thre_pb;
+  else threshold = std::max(1, static_cast<int32_t>(getratio(nread, genome.getlenmpbl()) * 10));
+
+  std::cout << "Checking redundant reads: redundancy threshold " << threshold << std::endl;
+
+  double r4cmp(getratio(ncmp, nread));
+  lackOfReads = (r4cmp >= 1);
+  std::vector<uint64_t> vnsampled(genome.chr.size(), 0);
+  std::vector<uint64_t> vnnonred(genome.chr.size(), 0);
+
+  boost::thread_group agroup;
+  for (auto &x: genome.vsepchr) {
+    agroup.create_thread(boost::bind(filterChromosomes, boost::ref(genome), x.s, x.e, threshold, nofilter, r4cmp,
+                                     boost::ref(vnsampled), boost::ref(vnnonred)));
+  }
+  agroup.join_all();
+
+  nread_cmp = nread_cmp_nonred = 0;
+  for (size_t i=0; i<genome.chr.size(); ++i) {
+    nread_cmp += vnsampled[i];
+    nread_cmp_nonred += vnnonred[i];
+  }
+
+  DEBUGprint_FUNCend();
+  return;
+}
+
+void RedundantReadFilter::print(std::ofstream &out) const
+{
+  // parenthesized when the reads are fewer than --ncmp
+  if (lackOfReads) {
+    out << boost::format("Library complexity: (%1$.3f) (%2%/%3%)\n")
+      % getcomplexity() % nread_cmp_nonred % nread_cmp;
+  } else {
+    out << boost::format("Library complexity: %1$.3f (%2%/%3%)\n")
+      % getcomplexity() % nread_cmp_nonred % nread_cmp;
+  }
+}
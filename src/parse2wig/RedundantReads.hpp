@@ -0,0 +1,46 @@
+/* Copyright(c)  Ryuichiro Nakato <rnakato@iqb.u-tokyo.ac.jp>
+ * All rights reserved.
+ */
+#ifndef _REDUNDANTREADS_HPP_
+#define _REDUNDANTREADS_HPP_
+
+#include <fstream>
+#include "../submodules/SSP/common/BoostOptions.hpp"
+#include "../submodules/SSP/common/inline.hpp"
+
+class SeqStatsGenomeSSP;
+
+/* PCR duplicate filtering in linear time.
+ * Reads are grouped by their 5' position (and the mate position for paired-end)
+ * with a radix sort for each chromosome and strand, and reads beyond the threshold
+ * in each group are marked as redundant. The options are defined by LibComp. */
+class RedundantReadFilter {
+  int32_t thre_pb;
+  int64_t ncmp;
+  bool nofilter;
+
+  int32_t threshold;
+  bool lackOfReads;
+  uint64_t nread_cmp;
+  uint64_t nread_cmp_nonred;
+
+public:
+  RedundantReadFilter():
+    thre_pb(0), ncmp(0), nofilter(false),
+    threshold(0), lackOfReads(false), nread_cmp(0), nread_cmp_nonred(0)
+  {}
+
+  void setValues(const MyOpt::Variables &values) {
+    thre_pb  = MyOpt::getVal<int32_t>(values, "thre_pb");
+    ncmp     = MyOpt::getVal<int64_t>(values, "ncmp");
+    nofilter = values.count("nofilter");
+  }
+
+  void checkRedundantReads(SeqStatsGenomeSSP &genome);
+
+  int32_t getThreshold() const { return threshold; }
+  double getcomplexity() const { return getratio(nread_cmp_nonred, nread_cmp); }
+  void print(std::ofstream &out) const;
+};
+
+#endif /* _REDUNDANTREADS_HPP_ */
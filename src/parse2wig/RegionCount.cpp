@@ -0,0 +1,151 @@
+/* Copyright(c)  Ryuichiro Nakato <rnakato@iqb.u-tokyo.ac.jp>
+ * All rights reserved.
+ */
+#include <algorithm>
+#include <unordered_map>
+#include <boost/filesystem.hpp>
+#include "RegionCount.hpp"
+#include "pw_gv.hpp"
+#include "pw_makefile.hpp"
+#include "ReadMpbldata.hpp"
+#include "SplitReference.hpp"
+
+namespace {
+  class Boundary {
+  public:
+    int64_t pos;
+    int64_t n;
+    double w;
+    Boundary(const int64_t p, const double _w): pos(p), n(1), w(_w) {}
+    bool operator<(const Boundary &x) const { return pos < x.pos; }
+  };
+
+  /* sorted fragment starts and ends with the cumulative numbers and weights.
+     The fragments are the regions added to the wig (getReadRegion), so that --rcenter and --onlyreadregion apply. */
+  class FragmentIndex {
+    std::vector<Boundary> vstart;
+    std::vector<Boundary> vend;
+
+    static void accumulate(std::vector<Boundary> &v) {
+      std::sort(v.begin(), v.end());
+      for (size_t i=1; i<v.size(); ++i) {
+        v[i].n += v[i-1].n;
+        v[i].w += v[i-1].w;
+      }
+    }
+    /* the boundary before the first one >= pos (nullptr: none) */
+    static const Boundary * getlast(const std::vector<Boundary> &v, const int64_t pos) {
+      auto itr = std::lower_bound(v.begin(), v.end(), Boundary(pos, 0));
+      if (itr == v.begin()) return nullptr;
+      return &*(itr-1);
+    }
+
+  public:
+    FragmentIndex(const Mapfile &p, const SeqStats &chr) {
+      int64_t s[2], e[2];
+      for (auto strand: {Strand::FWD, Strand::REV}) {
+        for (auto &x: chr.getvReadref(strand)) {
+          if (x.duplicate) continue;
+          int32_t n(getReadRegion(p.wsGenome, x, chr.getlen(), p.genome.dflen.getlenF3(), p.genome.dflen.getlenF5(), s, e));
+          for (int32_t i=0; i<n; ++i) {
+            vstart.emplace_back(s[i], x.getWeight());
+            vend.emplace_back(e[i], x.getWeight());
+          }
+        }
+      }
+      accumulate(vstart);
+      accumulate(vend);
+    }
+
+    /* fragments [s, e] overlapping [start, end): s < end and e >= start.
+       Fragments with e < start always satisfy s < end. */
+    void count(const int64_t start, const int64_t end, int64_t &n, double &w) const {
+      auto s = getlast(vstart, end);
+      auto e = getlast(vend, start);
+      n = (s ? s->n : 0) - (e ? e->n : 0);
+      w = (s ? s->w : 0) - (e ? e->w : 0);
+    }
+  };
+
+  /* mappability normalization of the wig (count * binsize / mappable length of the bin),
+     applied to a region with the mappable length summed over the bins it overlaps */
+  double getMpblFactor(const Mapfile &p, const std::vector<int32_t> &mparray, const int64_t start, const int64_t end)
+  {
+    int32_t binsize(p.wsGenome.getbinsize());
+    int64_t sbin(std::max(static_cast<int64_t>(0), start/binsize));
+    int64_t ebin(std::min(static_cast<int64_t>(mparray.size()) -1, (end-1)/binsize));
+    double len(0), mpbl(0);
+    for (int64_t i=sbin; i<=ebin; ++i) {
+      int64_t overlap(std::min(end, (i+1)*binsize) - std::max(start, i*binsize));
+      len  += overlap;
+      mpbl += mparray[i] * overlap / static_cast<double>(binsize);
+    }
+    if (mpbl > p.getmpthre() * len) return getratio(len, mpbl);
+    return 1;
+  }
+
+  void outputRegionCount(const Mapfile &p, const std::string &bedfile, const std::string &filename)
+  {
+    auto vbed = parseBed<bed>(bedfile);
+    std::vector<int64_t> count(vbed.size(), 0);
+    std::vector<double> normalized(vbed.size(), 0);
+
+    // the regions of each chromosome
+    std::unordered_map<std::string, std::vector<size_t>> mp;
+    for (size_t j=0; j<vbed.size(); ++j) mp[vbed[j].chr].emplace_back(j);
+
+    for (size_t i=0; i<p.genome.getnchr(); ++i) {
+      if (p.spikein.isSpikein(i)) continue;
+      // a part of a split chromosome counts the regions of the chromosome within the part
+      auto part = SplitReference::getPart(p.genome.chr[i].getname());
+      int64_t base(part ? part->base : 0);
+      int64_t len(p.genome.chr[i].getlen());
+      auto itr = mp.find(part ? rmchr(part->refname) : rmchr(p.genome.chr[i].getname()));
+      if (itr == mp.end()) continue;
+
+      double w(p.rpm.getType() != "NONE" ? p.genome.getsizefactor(i) : 1);
+      std::vector<int32_t> mparray;
+      if (p.getMpblBinaryDir() != "") {
+        mparray = readMpblWigArray(p.getMpblBinaryDir(), ("chr" + p.genome.chr[i].getname()),
+                                   p.wsGenome.getbinsize(), p.wsGenome.chr[i].getnbin());
+      }
+      FragmentIndex index(p, p.genome.chr[i]);
+      for (auto j: itr->second) {
+        int64_t start(std::max(vbed[j].start - base, static_cast<int64_t>(0)));
+        int64_t end(part ? std::min(vbed[j].end - base, len) : vbed[j].end);
+        if (start >= end) continue;
+        int64_t n(0);
+        double weighted(0);
+        index.count(start, end, n, weighted);
+        count[j] += n;
+        double sizefactor(w);
+        if (mparray.size()) sizefactor *= getMpblFactor(p, mparray, start, end);
+        normalized[j] += weighted * sizefactor;
+      }
+    }
+
+    std::ofstream out(filename);
+    out << "chromosome\tstart\tend\tread count\tnormalized read count" << std::endl;
+    for (size_t j=0; j<vbed.size(); ++j) {
+      out << boost::format("%1%\t%2%\t%3$.3f\n") % vbed[j].getSiteStrTAB() % count[j] % normalized[j];
+    }
+
+    std::cout << "region count is output in " << filename << "." << std::endl;
+  }
+}
+
+void RegionCount::setValues(const MyOpt::Variables &values)
+{
+  if (!values.count("regioncount")) return;
+
+  ParseLine(vbedfile, MyOpt::getVal<std::string>(values, "regioncount"), ',');
+  for (auto &x: vbedfile) isFile(x);
+}
+
+void RegionCount::output(const Mapfile &p) const
+{
+  for (auto &x: vbedfile) {
+    std::string stem(boost::filesystem::path(x).stem().string());
+    outputRegionCount(p, x, p.getprefix() + "." + stem + ".regioncount.tsv");
+  }
+}
@@ -0,0 +1,45 @@
+/* Copyright(c)  Ryuichiro Nakato <rnakato@iqb.u-tokyo.ac.jp>
+ * All rights reserved.
+ */
+#ifndef _REGIONCOUNT_HPP_
+#define _REGIONCOUNT_HPP_
+
+#include <vector>
+#include <string>
+#include "../submodules/SSP/common/BoostOptions.hpp"
+#include "../submodules/SSP/common/inline.hpp"
+
+class Mapfile;
+
+/* Read counts of the regions in BED files (--regioncount).
+ * Counted from the read store after the wig data is generated, with the same scaling weight. */
+class RegionCount {
+  MyOpt::Opts opt;
+  std::vector<std::string> vbedfile;
+
+public:
+  RegionCount():
+    opt("Region count",100)
+  {
+    opt.add_options()
+      ("regioncount", boost::program_options::value<std::string>(),
+       "BED files (comma-separated) of regions to output the read counts (e.g., promoters, peaks)")
+      ;
+  }
+
+  void setOpts(MyOpt::Opts &allopts) {
+    allopts.add(opt);
+  }
+  void setValues(const MyOpt::Variables &values);
+  void dump() const {
+    if (!isOn()) return;
+    std::cout << "Region count:";
+    for (auto &x: vbedfile) std::cout << " " << x;
+    std::cout << std::endl;
+  }
+
+  bool isOn() const { return !vbedfile.empty(); }
+  void output(const Mapfile &p) const;
+};
+
+#endif /* _REGIONCOUNT_HPP_ */
@@ -0,0 +1,196 @@
+/* Copyright(c)  Ryuichiro Nakato <rnakato@iqb.u-tokyo.ac.jp>
+ * All rights reserved.
+ */
+#include <fstream>
+#include <algorithm>
+#include <boost/format.hpp>
+#include <boost/filesystem.hpp>
+#include "ResourcePlan.hpp"
+#include "pw_gv.hpp"
+#include "GzipReader.hpp"
+#include "../submodules/SSP/src/SeqStats.hpp"
+
+namespace {
+  enum {BAM_BYTES_PER_READ=20,   // lower bound of BAM record size, to overestimate read number
+        TEXT_BYTES_PER_READ=40,  // SAM/BED/TAGALIGN lines
+        BAI_PSEUDO_BIN=37450,
+        MPBLWIG_BYTES_PER_BIN=24};  // a line of the mappability wig ("%ld\t%.4f\n") decoded at once
+
+  /* approximate single-core costs (sec) per read or per base, for the order of the runtime.
+     They are not calibrated on the running machine (reported as such by print()). */
+  const double costReadInput(1.0e-6);   // per read (decompression and parsing)
+  const double costRedundant(1.5e-7);   // per read
+  const double costShiftProfile(4e-9);  // per mappable base
+  const double costPerBase(3e-9);       // per base for the per-base arrays
+  const double costWig(2e-7);           // per read
+  const double costOutput(1e-7);        // per bin
+
+  template <class T>
+  bool readBinary(std::ifstream &in, T &val)
+  {
+    return static_cast<bool>(in.read(reinterpret_cast<char *>(&val), sizeof(T)));
+  }
+
+  /* number of mapped and unmapped reads from the pseudo-bins of a BAI file (as samtools idxstats) */
+  bool readBaiStats(const std::string &filename, uint64_t &nmapped, uint64_t &nunmapped)
+  {
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) return false;
+
+    char magic[4];
+    in.read(magic, 4);
+    if (!in || magic[0] != 'B' || magic[1] != 'A' || magic[2] != 'I' || magic[3] != 1) return false;
+
+    nmapped = nunmapped = 0;
+    int32_t nref(0);
+    if (!readBinary(in, nref)) return false;
+    for (int32_t i=0; i<nref; ++i) {
+      int32_t nbin(0);
+      if (!readBinary(in, nbin)) return false;
+      for (int32_t j=0; j<nbin; ++j) {
+        uint32_t bin(0);
+        int32_t nchunk(0);
+        if (!readBinary(in, bin) || !readBinary(in, nchunk)) return false;
+        if (bin == BAI_PSEUDO_BIN && nchunk == 2) {
+          uint64_t v[4];
+          for (auto &x: v) readBinary(in, x);
+          nmapped   += v[2];
+          nunmapped += v[3];
+        } else {
+          in.seekg(nchunk * 2 * sizeof(uint64_t), std::ios::cur);
+        }
+      }
+      int32_t nintv(0);
+      if (!readBinary(in, nintv)) return false;
+      in.seekg(nintv * sizeof(uint64_t), std::ios::cur);
+    }
+    uint64_t nnocoor(0);
+    if (readBinary(in, nnocoor)) nunmapped += nnocoor;
+    return true;
+  }
+
+  std::string getBaiName(const std::string &bam)
+  {
+    if (boost::filesystem::exists(bam + ".bai")) return bam + ".bai";
+    std::string bai(boost::filesystem::path(bam).replace_extension(".bai").string());
+    if (boost::filesystem::exists(bai)) return bai;
+    return "";
+  }
+
+  bool isBam(const std::string &filename)
+  {
+    return boost::filesystem::path(filename).extension() == ".bam";
+  }
+}
+
+void ResourcePlan::countReads(const std::string &inputfile, const bool isPaired)
+{
+  nread = 0;
+  fromIndex = true;
+
+  std::vector<std::string> v;
+  ParseLine(v, inputfile, ',');
+  for (auto &x: v) {
+    uint64_t nmapped(0), nunmapped(0);
+    std::string bai(isBam(x) ? getBaiName(x) : "");
+    if (bai != "" && readBaiStats(bai, nmapped, nunmapped)) {
+      nread += isPaired ? nmapped/2 : nmapped;  // a pair is stored as one fragment
+    } else {
+      fromIndex = false;
+      uint64_t filesize(boost::filesystem::file_size(x));
+      nread += filesize / (isBam(x) ? BAM_BYTES_PER_READ : TEXT_BYTES_PER_READ);
+    }
+  }
+}
+
+ResourcePlan::ResourcePlan(const Mapfile &p, const std::string &inputfile):
+  nread(0), fromIndex(false), memReadStore(0)
+{
+  countReads(inputfile, p.genome.isPaired());
+  // the read vectors grow by doubling, so their capacity is up to twice the reads
+  memReadStore = 2 * nread * sizeof(Read);
+
+  uint64_t lengenome(0), lenmax(0);
+  int64_t nbinmax(0);
+  for (size_t i=0; i<p.genome.chr.size(); ++i) {
+    uint64_t len(p.genome.chr[i].getlen());
+    lengenome += len;
+    lenmax = std::max(lenmax, len);
+    nbinmax = std::max(nbinmax, p.wsGenome.chr[i].getnbin());
+  }
+  int64_t nbintotal(p.wsGenome.genome.getnbin());
+
+  // per-chromosome arrays are held for one chromosome at a time unless noted
+  double nthread(std::max(static_cast<size_t>(1), p.genome.vsepchr.size()));
+
+  vstage.emplace_back("read input", 0, nread * costReadInput);
+  vstage.emplace_back("redundant reads", 0, nread * costRedundant / nthread);
+
+  if (!p.genome.isPaired() && !p.genome.dflen.isnomodel()) {
+    double len(p.fastflen.isOn() ? 0 : lengenome);
+    // bit arrays of the forward and reverse reads and the mappability of a chromosome in each thread
+    uint64_t mem(0);
+    if (!p.fastflen.isOn()) {
+      for (auto &x: p.genome.vsepchr) {
+        uint64_t lenthread(0);
+        for (int32_t i=x.s; i<=x.e; ++i) lenthread = std::max(lenthread, static_cast<uint64_t>(p.genome.chr[i].getlen()));
+        mem += lenthread * 3 / 8;
+      }
+    }
+    vstage.emplace_back("fragment length", mem, len * costShiftProfile / nthread);
+  }
+
+  // BpStatus array of each chromosome (GenomeCov::makeGcovArray), with the binary mappability file decoded in chunks.
+  // In --batch the array parsed from the file is also held while its mappable runs are shared.
+  uint64_t memgcov(lenmax * sizeof(BpStatus));
+  if (p.getMpblBinaryDir() != "") memgcov += lenmax * sizeof(BpStatus) + GzipStreamBuf::getMemorySize() + NUM_1M;
+  vstage.emplace_back("genome coverage", memgcov, lengenome * costPerBase);
+
+  if (p.gc.isGcNormOn()) {
+    // the longest chromosome for the GC distribution, then a FASTA array in each thread (weightRead)
+    uint64_t mem(lenmax * (sizeof(short) + sizeof(BpStatus)));
+    uint64_t memthreads(0);
+    for (auto &x: p.genome.vsepchr) {
+      uint64_t len(0);
+      for (int32_t i=x.s; i<=x.e; ++i) len = std::max(len, static_cast<uint64_t>(p.genome.chr[i].getlen()));
+      memthreads += len * sizeof(short);
+    }
+    vstage.emplace_back("GC normalization", std::max(mem, memthreads), lengenome * costPerBase * 2 / nthread);
+  }
+
+  // WigArrays of all reads and the read partitions (count_and_normalize_Wigarray), with the mappability wig
+  uint64_t memwig((p.partition.size() +1) * nbinmax * sizeof(int64_t) + nbinmax * sizeof(int32_t));
+  if (p.getMpblBinaryDir() != "") memwig += nbinmax * MPBLWIG_BYTES_PER_BIN;
+  if (p.wsGenome.isbpres()) memwig += 2 * nread * getratio(lenmax, lengenome) * 2 * sizeof(int64_t);
+  vstage.emplace_back("wig data", memwig,
+                      nread * costWig + (p.partition.size() +1) * nbintotal * costOutput);
+}
+
+uint64_t ResourcePlan::getPeakMemory() const
+{
+  uint64_t mem(0);
+  for (auto &x: vstage) mem = std::max(mem, x.memory);
+  return memReadStore + mem;
+}
+
+double ResourcePlan::getRuntime() const
+{
+  double time(0);
+  for (auto &x: vstage) time += x.time;
+  return time;
+}
+
+void ResourcePlan::print() const
+{
+  std::cout << "\nResource plan (no data is processed):" << std::endl;
+  std::cout << boost::format("  reads: %1% (%2%)\n")
+    % nread % (fromIndex ? "from BAM index" : "estimated from file size");
+  std::cout << boost::format("  read store: %1$.1f MB\n") % (memReadStore / static_cast<double>(NUM_1M));
+  std::cout << boost::format("  %1$-20s\t%2$12s\t%3$10s\n") % "stage" % "memory (MB)" % "time (sec)";
+  for (auto &x: vstage) {
+    std::cout << boost::format("  %1$-20s\t%2$12.1f\t%3$10.1f\n")
+      % x.name % ((memReadStore + x.memory) / static_cast<double>(NUM_1M)) % x.time;
+  }
+  std::cout << boost::format("  peak memory: %1$.1f MB\n") % (getPeakMemory() / static_cast<double>(NUM_1M));
+  std::cout << boost::format("  estimated runtime: %1$.0f sec (uncalibrated, order of magnitude only)\n") % getRuntime();
+}
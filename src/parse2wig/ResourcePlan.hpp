@@ -0,0 +1,41 @@
+/* Copyright(c)  Ryuichiro Nakato <rnakato@iqb.u-tokyo.ac.jp>
+ * All rights reserved.
+ */
+#ifndef _RESOURCEPLAN_HPP_
+#define _RESOURCEPLAN_HPP_
+
+#include <vector>
+#include <string>
+
+class Mapfile;
+
+/* Expected memory and runtime of parse2wig+ (--plan, and the memory budget of --batch).
+ * The read number is taken from the BAM index (.bai) when available, otherwise estimated from the file size.
+ * The array sizes follow the allocations in the pipeline. */
+class ResourcePlan {
+public:
+  class Stage {
+  public:
+    std::string name;
+    uint64_t memory;  // bytes in addition to the read store
+    double time;      // sec
+    Stage(const std::string &n, const uint64_t m, const double t): name(n), memory(m), time(t) {}
+  };
+
+private:
+  uint64_t nread;
+  bool fromIndex;
+  uint64_t memReadStore;
+  std::vector<Stage> vstage;
+
+  void countReads(const std::string &inputfile, const bool isPaired);
+
+public:
+  ResourcePlan(const Mapfile &p, const std::string &inputfile);
+
+  uint64_t getPeakMemory() const;
+  double getRuntime() const;
+  void print() const;
+};
+
+#endif /* _RESOURCEPLAN_HPP_ */
@@ -0,0 +1,138 @@
+/* Copyright(c)  Ryuichiro Nakato <rnakato@iqb.u-tokyo.ac.jp>
+ * All rights reserved.
+ */
+#include <fstream>
+#include <sstream>
+#include <memory>
+#include <unordered_map>
+#include <boost/thread.hpp>
+#include "SharedReference.hpp"
+#include "../submodules/SSP/common/inline.hpp"
+
+namespace {
+  template <class T>
+  class Entry {
+  public:
+    boost::mutex mtx;
+    bool loaded;
+    T data;
+    Entry(): loaded(false) {}
+  };
+
+  template <class T>
+  class Cache {
+    boost::mutex mtx;
+    std::unordered_map<std::string, std::shared_ptr<Entry<T>>> mp;
+    uint64_t size;  // bytes of the loaded entries
+
+  public:
+    Cache(): size(0) {}
+
+    /* the global lock is held only to find the entry, so that
+       different files can be loaded concurrently by different samples */
+    Entry<T> & getEntry(const std::string &filename) {
+      boost::mutex::scoped_lock lock(mtx);
+      auto &p = mp[filename];
+      if (!p) p = std::make_shared<Entry<T>>();
+      return *p;
+    }
+
+    /* called with the lock of the entry after it is loaded */
+    void addMemoryUsage(const uint64_t s) {
+      boost::mutex::scoped_lock lock(mtx);
+      size += s;
+    }
+    uint64_t getMemoryUsage() {
+      boost::mutex::scoped_lock lock(mtx);
+      return size;
+    }
+
+    void clear() {
+      boost::mutex::scoped_lock lock(mtx);
+      mp.clear();
+      size = 0;
+    }
+  };
+
+  bool active(false);
+  Cache<std::vector<int32_t>> cacheMpblWig;
+  Cache<std::vector<SharedReference::MpblRun>> cacheMpblRuns;
+  Cache<std::string> cacheFile;
+
+  std::vector<SharedReference::MpblRun> getRuns(const std::vector<BpStatus> &array)
+  {
+    std::vector<SharedReference::MpblRun> runs;
+    int64_t len(array.size());
+    int64_t i(0);
+    while (i < len) {
+      if (array[i] != BpStatus::MAPPABLE) {
+        ++i;
+        continue;
+      }
+      int64_t s(i);
+      while (i < len && array[i] == BpStatus::MAPPABLE) ++i;
+      runs.emplace_back(s, i);
+    }
+    runs.shrink_to_fit();
+    return runs;
+  }
+}
+
+namespace SharedReference {
+  void activate() { active = true; }
+  bool isActive() { return active; }
+
+  const std::vector<int32_t> & getMpblWigArray(const std::string &filename,
+                                               const std::function<std::vector<int32_t>()> &load)
+  {
+    auto &entry = cacheMpblWig.getEntry(filename);
+    boost::mutex::scoped_lock lock(entry.mtx);
+    if (!entry.loaded) {
+      entry.data = load();
+      entry.loaded = true;
+      cacheMpblWig.addMemoryUsage(entry.data.size() * sizeof(int32_t));
+    }
+    return entry.data;
+  }
+
+  const std::vector<MpblRun> & getMpblRuns(const std::string &filename,
+                                           const std::function<std::vector<BpStatus>()> &load)
+  {
+    auto &entry = cacheMpblRuns.getEntry(filename);
+    boost::mutex::scoped_lock lock(entry.mtx);
+    if (!entry.loaded) {
+      entry.data = getRuns(load());
+      entry.loaded = true;
+      cacheMpblRuns.addMemoryUsage(entry.data.size() * sizeof(MpblRun));
+    }
+    return entry.data;
+  }
+
+  const std::string & getFileContent(const std::string &filename)
+  {
+    auto &entry = cacheFile.getEntry(filename);
+    boost::mutex::scoped_lock lock(entry.mtx);
+    if (!entry.loaded) {
+      std::ifstream in(filename);
+      if (!in) PRINTERR_AND_EXIT("Could not open " << filename << ".");
+      std::ostringstream ss;
+      ss << in.rdbuf();
+      entry.data = ss.str();
+      entry.loaded = true;
+      cacheFile.addMemoryUsage(entry.data.size());
+    }
+    return entry.data;
+  }
+
+  uint64_t getMemoryUsage()
+  {
+    return cacheMpblWig.getMemoryUsage() + cacheMpblRuns.getMemoryUsage() + cacheFile.getMemoryUsage();
+  }
+
+  void release()
+  {
+    cacheMpblWig.clear();
+    cacheMpblRuns.clear();
+    cacheFile.clear();
+  }
+}
@@ -0,0 +1,37 @@
+/* Copyright(c)  Ryuichiro Nakato <rnakato@iqb.u-tokyo.ac.jp>
+ * All rights reserved.
+ */
+#ifndef _SHAREDREFERENCE_HPP_
+#define _SHAREDREFERENCE_HPP_
+
+#include <string>
+#include <vector>
+#include <functional>
+#include "BpStatus.hpp"
+
+/* Reference data (mappability and genome sequence) shared among samples in --batch mode.
+ * Each file is loaded at the first request and kept in memory for the following samples.
+ * When not activated, every request reads the file as before. */
+namespace SharedReference {
+  class MpblRun {
+  public:
+    int64_t start;
+    int64_t end;
+    MpblRun(const int64_t s, const int64_t e): start(s), end(e) {}
+  };
+
+  void activate();
+  bool isActive();
+
+  const std::vector<int32_t> & getMpblWigArray(const std::string &filename,
+                                               const std::function<std::vector<int32_t>()> &load);
+  const std::vector<MpblRun> & getMpblRuns(const std::string &filename,
+                                           const std::function<std::vector<BpStatus>()> &load);
+  const std::string & getFileContent(const std::string &filename);
+
+  uint64_t getMemoryUsage();
+  /* frees all cached data; no sample may be running */
+  void release();
+}
+
+#endif /* _SHAREDREFERENCE_HPP_ */
@@ -0,0 +1,224 @@
+/* Copyright(c)  Ryuichiro Nakato <rnakato@iqb.u-tokyo.ac.jp>
+ * All rights reserved.
+ */
+#include <fstream>
+#include <random>
+#include <algorithm>
+#include <boost/format.hpp>
+#include "ShiftProfileSampling.hpp"
+#include "../submodules/SSP/src/SeqStats.hpp"
+
+namespace {
+  enum {SEED=1, BLOCKSIZE=10, NBOOTSTRAP=100, NWIN_FIRSTROUND=100};
+
+  class Window {
+  public:
+    int32_t id;
+    int64_t start;
+    Window(const int32_t i, const int64_t s): id(i), start(s) {}
+  };
+
+  /* sum of the profiles of BLOCKSIZE windows, the unit of bootstrap resampling */
+  class ProfileBlock {
+  public:
+    std::vector<double> nmatch;
+    std::vector<double> nunion;
+    std::vector<double> nmatch_bg;  // at the background shifts (--ng_from, --ng_to, --ng_step)
+    std::vector<double> nunion_bg;
+    double nF, nR;   // 5' ends in the windows, for the uniform expectation
+    double len;
+    ProfileBlock(const int32_t mp_to, const size_t nbg):
+      nmatch(mp_to+1, 0), nunion(mp_to+1, 0),
+      nmatch_bg(nbg, 0), nunion_bg(nbg, 0),
+      nF(0), nR(0), len(0)
+    {}
+  };
+
+  /* sorted 5' ends of nonredundant reads, prepared at the first window on each chromosome */
+  class ChrPosition {
+  public:
+    bool done;
+    std::vector<int32_t> fwd;
+    std::vector<int32_t> rev;
+    ChrPosition(): done(false) {}
+
+    void set(const SeqStats &chr) {
+      for (auto &x: chr.getvReadref(Strand::FWD)) if (!x.duplicate) fwd.emplace_back(x.F3);
+      for (auto &x: chr.getvReadref(Strand::REV)) if (!x.duplicate) rev.emplace_back(x.F3);
+      // each position counted once as in the bit array of the full computation
+      std::sort(fwd.begin(), fwd.end());
+      fwd.erase(std::unique(fwd.begin(), fwd.end()), fwd.end());
+      std::sort(rev.begin(), rev.end());
+      rev.erase(std::unique(rev.begin(), rev.end()), rev.end());
+      done = true;
+    }
+  };
+
+  int64_t countRange(const std::vector<int32_t> &v, const int64_t s, const int64_t e)
+  {
+    return std::lower_bound(v.begin(), v.end(), e) - std::lower_bound(v.begin(), v.end(), s);
+  }
+
+  /* Jaccard counts between forward 5' ends in [start, start+winsize)
+     and reverse 5' ends shifted by 0..mp_to and by the background shifts.
+     The positions are sparse, so the pairs within mp_to are enumerated directly
+     and each background shift is looked up for every forward end. */
+  void addWindow(ProfileBlock &block, const ChrPosition &p, const int64_t start, const int32_t winsize,
+                 const int32_t mp_to, const std::vector<int32_t> &vshift_bg)
+  {
+    auto fbegin = std::lower_bound(p.fwd.begin(), p.fwd.end(), start);
+    auto fend   = std::lower_bound(fbegin, p.fwd.end(), start + winsize);
+    int64_t nF(fend - fbegin);
+
+    std::vector<int64_t> nmatch(mp_to+1, 0);
+    auto r = std::lower_bound(p.rev.begin(), p.rev.end(), start);
+    for (auto f = fbegin; f != fend; ++f) {
+      while (r != p.rev.end() && *r < *f) ++r;
+      for (auto itr = r; itr != p.rev.end() && *itr <= *f + mp_to; ++itr) ++nmatch[*itr - *f];
+    }
+
+    for (int32_t d=0; d<=mp_to; ++d) {
+      int64_t nR(countRange(p.rev, start + d, start + d + winsize));
+      block.nmatch[d] += nmatch[d];
+      block.nunion[d] += nF + nR - nmatch[d];
+    }
+
+    for (size_t j=0; j<vshift_bg.size(); ++j) {
+      int64_t d(vshift_bg[j]);
+      int64_t n(0);
+      for (auto f = fbegin; f != fend; ++f) n += std::binary_search(p.rev.begin(), p.rev.end(), *f + d);
+      int64_t nR(countRange(p.rev, start + d, start + d + winsize));
+      block.nmatch_bg[j] += n;
+      block.nunion_bg[j] += nF + nR - n;
+    }
+
+    block.nF += nF;
+    block.nR += countRange(p.rev, start, start + winsize);
+    block.len += winsize;
+  }
+
+  int32_t getPeak(const std::vector<double> &nmatch, const std::vector<double> &nunion, const int32_t dmin)
+  {
+    int32_t peak(dmin);
+    double max(-1);
+    for (size_t d=dmin; d<nmatch.size(); ++d) {
+      double j(getratio(nmatch[d], nunion[d]));
+      if (j > max) {
+        max = j;
+        peak = d;
+      }
+    }
+    return peak;
+  }
+
+  void getBootstrapCI(const std::vector<ProfileBlock> &vblock, const int32_t ng_to, const int32_t dmin,
+                      std::mt19937 &mt, int32_t &low, int32_t &high)
+  {
+    std::uniform_int_distribution<int32_t> dist(0, vblock.size() -1);
+    std::vector<int32_t> vpeak;
+    for (int32_t i=0; i<NBOOTSTRAP; ++i) {
+      std::vector<double> nmatch(ng_to+1, 0), nunion(ng_to+1, 0);
+      for (size_t j=0; j<vblock.size(); ++j) {
+        auto &x = vblock[dist(mt)];
+        for (int32_t d=dmin; d<=ng_to; ++d) {
+          nmatch[d] += x.nmatch[d];
+          nunion[d] += x.nunion[d];
+        }
+      }
+      vpeak.emplace_back(getPeak(nmatch, nunion, dmin));
+    }
+    std::sort(vpeak.begin(), vpeak.end());
+    low  = vpeak[NBOOTSTRAP * 0.025];
+    high = vpeak[NBOOTSTRAP * 0.975];
+  }
+}
+
+void ShiftProfileSampling::estimate(const std::vector<SeqStats> &chr,
+                                    const int32_t ng_from, const int32_t ng_to, const int32_t ng_step,
+                                    const int32_t lenF3)
+{
+  DEBUGprint_FUNCStart();
+
+  int32_t mp_to(MP_TO);
+  readlen = std::min(lenF3, mp_to);
+  // skip the phantom peak at the read length
+  int32_t dmin(std::min(static_cast<int32_t>(readlen * 1.5), mp_to));
+
+  // the background is taken at the same shifts as the full computation
+  std::vector<int32_t> vshift_bg;
+  for (int32_t d=ng_from; d<=ng_to; d += std::max(1, ng_step)) vshift_bg.emplace_back(d);
+  int32_t maxshift(std::max(mp_to, vshift_bg.empty() ? 0 : vshift_bg.back()));
+
+  // windows tiling the autosomes, visited in random order so that chromosomes are weighted by length
+  std::vector<Window> vwin;
+  for (size_t i=0; i<chr.size(); ++i) {
+    if (!chr[i].isautosome()) continue;
+    int64_t len(chr[i].getlen());
+    for (int64_t s=0; s + winsize + maxshift <= len; s += winsize) vwin.emplace_back(i, s);
+  }
+  if (vwin.empty()) PRINTERR_AND_EXIT("No autosome is longer than --fastflen_window + --ng_to.");
+
+  std::mt19937 mt(SEED);
+  std::shuffle(vwin.begin(), vwin.end(), mt);
+  size_t nmax(std::min(vwin.size(), static_cast<size_t>(maxwin)));
+
+  std::vector<ChrPosition> vpos(chr.size());
+  std::vector<ProfileBlock> vblock;
+  size_t nround(NWIN_FIRSTROUND);
+  size_t i(0);
+  while (i < nmax) {
+    size_t end(std::min(nround, nmax));
+    for (; i<end; ++i) {
+      if (!(i % BLOCKSIZE)) vblock.emplace_back(mp_to, vshift_bg.size());
+      auto &p = vpos[vwin[i].id];
+      if (!p.done) p.set(chr[vwin[i].id]);
+      addWindow(vblock.back(), p, vwin[i].start, winsize, mp_to, vshift_bg);
+    }
+    getBootstrapCI(vblock, mp_to, dmin, mt, ci_low, ci_high);
+    std::cout << boost::format("  %1% windows: 95%% CI of fragment length %2%-%3%\n") % i % ci_low % ci_high;
+    if (ci_high - ci_low <= tol) break;
+    nround *= 2;
+  }
+  nwin = i;
+
+  ProfileBlock sum(mp_to, vshift_bg.size());
+  for (auto &x: vblock) {
+    for (int32_t d=0; d<=mp_to; ++d) {
+      sum.nmatch[d] += x.nmatch[d];
+      sum.nunion[d] += x.nunion[d];
+    }
+    for (size_t j=0; j<vshift_bg.size(); ++j) {
+      sum.nmatch_bg[j] += x.nmatch_bg[j];
+      sum.nunion_bg[j] += x.nunion_bg[j];
+    }
+    sum.nF += x.nF;
+    sum.nR += x.nR;
+    sum.len += x.len;
+  }
+
+  jac.assign(mp_to+1, 0);
+  for (int32_t d=0; d<=mp_to; ++d) jac[d] = getratio(sum.nmatch[d], sum.nunion[d]);
+  flen = getPeak(sum.nmatch, sum.nunion, dmin);
+
+  // background: mean Jaccard index over the background shifts
+  bg = 0;
+  for (size_t j=0; j<vshift_bg.size(); ++j) bg += getratio(sum.nmatch_bg[j], sum.nunion_bg[j]);
+  bg = getratio(bg, vshift_bg.size());
+
+  // background uniformity: the background relative to the Jaccard index of uniformly distributed 5' ends
+  double pF(getratio(sum.nF, sum.len));
+  double pR(getratio(sum.nR, sum.len));
+  bu = getratio(bg, getratio(pF * pR, pF + pR - pF * pR));
+
+  DEBUGprint_FUNCend();
+  return;
+}
+
+void ShiftProfileSampling::outputProfile(const std::string &filename) const
+{
+  std::ofstream out(filename);
+  out << "Strand shift\tJaccard index\tNormalized by background" << std::endl;
+  for (size_t d=0; d<jac.size(); ++d) {
+    out << d << "\t" << jac[d] << "\t" << getratio(jac[d], bg) << std::endl;
+  }
+}
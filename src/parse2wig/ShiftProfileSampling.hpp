@@ -0,0 +1,82 @@
+/* Copyright(c)  Ryuichiro Nakato <rnakato@iqb.u-tokyo.ac.jp>
+ * All rights reserved.
+ */
+#ifndef _SHIFTPROFILESAMPLING_HPP_
+#define _SHIFTPROFILESAMPLING_HPP_
+
+#include <vector>
+#include <string>
+#include "../submodules/SSP/common/BoostOptions.hpp"
+#include "../submodules/SSP/common/inline.hpp"
+
+class SeqStats;
+
+/* Fast fragment length estimation (--fastflen).
+ * The strand-shift Jaccard profile is accumulated on randomly sampled genomic windows
+ * until the bootstrap 95% CI of the peak shift becomes narrower than --fastflen_tol. */
+class ShiftProfileSampling {
+  enum {MP_TO=1000};  // maximum shift of the profile around the fragment length
+  MyOpt::Opts opt;
+
+  int32_t on;
+  int32_t tol;
+  int32_t winsize;
+  int32_t maxwin;
+
+  // results
+  int32_t flen;
+  int32_t nwin;
+  int32_t ci_low, ci_high;
+  double bg;   // background at the large shifts
+  double bu;   // background uniformity
+  std::vector<double> jac;
+  int32_t readlen;
+
+public:
+  ShiftProfileSampling():
+    opt("Fast fragment length estimation",100),
+    on(0), tol(0), winsize(0), maxwin(0),
+    flen(0), nwin(0), ci_low(0), ci_high(0), bg(0), bu(0), readlen(0)
+  {
+    opt.add_options()
+      ("fastflen", "estimate fragment length from randomly sampled genomic windows instead of whole chromosomes")
+      ("fastflen_tol",
+       boost::program_options::value<int32_t>()->default_value(10)->notifier(std::bind(&MyOpt::over<int32_t>, std::placeholders::_1, 0, "--fastflen_tol")),
+       "(for --fastflen) stop sampling when the 95% CI width of fragment length is below this value (bp)")
+      ("fastflen_window",
+       boost::program_options::value<int32_t>()->default_value(100000)->notifier(std::bind(&MyOpt::over<int32_t>, std::placeholders::_1, 1000, "--fastflen_window")),
+       "(for --fastflen) window size (bp)")
+      ("fastflen_maxwin",
+       boost::program_options::value<int32_t>()->default_value(5000)->notifier(std::bind(&MyOpt::over<int32_t>, std::placeholders::_1, 1, "--fastflen_maxwin")),
+       "(for --fastflen) maximum number of windows")
+      ;
+  }
+
+  void setOpts(MyOpt::Opts &allopts) {
+    allopts.add(opt);
+  }
+  void setValues(const MyOpt::Variables &values) {
+    on      = values.count("fastflen");
+    tol     = MyOpt::getVal<int32_t>(values, "fastflen_tol");
+    winsize = MyOpt::getVal<int32_t>(values, "fastflen_window");
+    maxwin  = MyOpt::getVal<int32_t>(values, "fastflen_maxwin");
+  }
+
+  int32_t isOn() const { return on; }
+
+  void estimate(const std::vector<SeqStats> &chr,
+                const int32_t ng_from, const int32_t ng_to, const int32_t ng_step,
+                const int32_t lenF3);
+  void outputProfile(const std::string &filename) const;
+
+  int32_t getflen() const { return flen; }
+  int32_t getnwin() const { return nwin; }
+  int32_t getCIlow() const { return ci_low; }
+  int32_t getCIhigh() const { return ci_high; }
+  double getnsc()  const { return getratio(jac[flen], bg); }
+  double getrlsc() const { return getratio(jac[readlen], bg); }
+  double getrsc()  const { return getratio(jac[flen] - bg, jac[readlen] - bg); }
+  double getbackgroundUniformity() const { return bu; }
+};
+
+#endif /* _SHIFTPROFILESAMPLING_HPP_ */
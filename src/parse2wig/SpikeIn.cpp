@@ -0,0 +1,71 @@
+/* Copyright(c)  Ryuichiro Nakato <rnakato@iqb.u-tokyo.ac.jp>
+ * All rights reserved.
+ */
+#include <algorithm>
+#include "SpikeIn.hpp"
+#include "../submodules/SSP/src/SeqStats.hpp"
+#include "../submodules/SSP/common/util.hpp"
+
+bool SpikeIn::match(const SeqStats &chr) const
+{
+  for (auto &x: vpattern) {
+    for (auto &name: {chr.getname(), chr.getrefname()}) {
+      if (x.back() == '*') {
+        if (name.compare(0, x.size() -1, x, 0, x.size() -1) == 0) return true;
+      } else if (name == x || name == rmchr(x)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void SpikeIn::setValues(const MyOpt::Variables &values, const std::vector<SeqStats> &chr)
+{
+  if (!values.count("spikein")) return;
+
+  ParseLine(vpattern, MyOpt::getVal<std::string>(values, "spikein"), ',');
+  vpattern.erase(std::remove(vpattern.begin(), vpattern.end(), ""), vpattern.end());
+  if (vpattern.empty()) PRINTERR_AND_EXIT("invalid --spikein.");
+
+  int32_t nspike(0);
+  for (auto &x: chr) {
+    isspike.emplace_back(match(x));
+    nspike += isspike.back();
+  }
+  if (!nspike) PRINTERR_AND_EXIT("no chromosome in the genome table matches --spikein.");
+  if (nspike == static_cast<int32_t>(chr.size())) PRINTERR_AND_EXIT("all chromosomes match --spikein.");
+}
+
+void SpikeIn::separate(SeqStatsGenomeSSP &genome)
+{
+  nread_spike = 0;
+  for (size_t i=0; i<genome.chr.size(); ++i) {
+    if (!isspike[i]) continue;
+    for (auto strand: {Strand::FWD, Strand::REV}) {
+      auto &seq = genome.chr[i].seq[strand];
+      nread_spike += seq.nread_nonred;
+      std::vector<Read>().swap(genome.chr[i].getvReadref_notconst(strand));
+      seq.nread = seq.nread_nonred = seq.nread_red = 0;
+    }
+  }
+  std::cout << "Spike-in reads (nonredundant): " << nread_spike << std::endl;
+}
+
+uint64_t SpikeIn::getnread_nonred(const SeqStatsGenomeSSP &genome) const
+{
+  uint64_t n(0);
+  for (size_t i=0; i<genome.chr.size(); ++i) {
+    if (isSpikein(i)) n += genome.chr[i].getnread_nonred(Strand::BOTH);
+  }
+  return n;
+}
+
+uint64_t SpikeIn::getlenmpbl(const SeqStatsGenomeSSP &genome) const
+{
+  uint64_t len(0);
+  for (size_t i=0; i<genome.chr.size(); ++i) {
+    if (isSpikein(i)) len += genome.chr[i].getlenmpbl();
+  }
+  return len;
+}
@@ -0,0 +1,63 @@
+/* Copyright(c)  Ryuichiro Nakato <rnakato@iqb.u-tokyo.ac.jp>
+ * All rights reserved.
+ */
+#ifndef _SPIKEIN_HPP_
+#define _SPIKEIN_HPP_
+
+#include <fstream>
+#include <vector>
+#include <string>
+#include "../submodules/SSP/common/BoostOptions.hpp"
+#include "../submodules/SSP/common/inline.hpp"
+
+class SeqStats;
+class SeqStatsGenomeSSP;
+
+/* Spike-in chromosomes of a combined reference genome (--spikein).
+ * Their nonredundant reads are counted from the read store and then removed,
+ * so that the genome outputs contain only the target genome. */
+class SpikeIn {
+  MyOpt::Opts opt;
+  std::vector<std::string> vpattern;
+  std::vector<int32_t> isspike;
+  uint64_t nread_spike;
+
+  bool match(const SeqStats &chr) const;
+
+public:
+  SpikeIn():
+    opt("Spike-in",100),
+    nread_spike(0)
+  {
+    opt.add_options()
+      ("spikein", boost::program_options::value<std::string>(),
+       "Spike-in chromosomes in the genome table (comma-separated). A name ending with '*' is a prefix (e.g., dm6_*)")
+      ;
+  }
+
+  void setOpts(MyOpt::Opts &allopts) {
+    allopts.add(opt);
+  }
+  void setValues(const MyOpt::Variables &values, const std::vector<SeqStats> &chr);
+  void dump() const {
+    if (!isOn()) return;
+    std::cout << "Spike-in chromosomes:";
+    for (auto &x: vpattern) std::cout << " " << x;
+    std::cout << std::endl;
+  }
+
+  bool isOn() const { return !vpattern.empty(); }
+  bool isSpikein(const int32_t id) const { return isOn() && isspike[id]; }
+
+  void separate(SeqStatsGenomeSSP &genome);
+
+  uint64_t getnread_spike() const { return nread_spike; }
+  /* nonredundant reads currently on the spike-in chromosomes (before separate()) */
+  uint64_t getnread_nonred(const SeqStatsGenomeSSP &genome) const;
+  uint64_t getlenmpbl(const SeqStatsGenomeSSP &genome) const;
+  void print(std::ofstream &out) const {
+    if (isOn()) out << "Spike-in reads (nonredundant): " << nread_spike << std::endl;
+  }
+};
+
+#endif /* _SPIKEIN_HPP_ */
@@ -0,0 +1,251 @@
+/* Copyright(c)  Ryuichiro Nakato <rnakato@iqb.u-tokyo.ac.jp>
+ * All rights reserved.
+ */
+#include <fstream>
+#include <unordered_map>
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/thread.hpp>
+#include "SplitReference.hpp"
+#include "GzipReader.hpp"
+#include "../submodules/SSP/src/htslib-1.10.2/htslib/sam.h"
+#include "../submodules/SSP/common/util.hpp"
+
+namespace {
+  enum : int64_t {MAXLEN=INT32_MAX,  // chromosomes of this length or longer are split
+                  PARTLEN=1LL<<30};  // rounded down to a multiple of the bin size
+
+  boost::mutex mtx;
+  bool initialized(false);
+  std::string gtfile("");
+  std::vector<SplitReference::Part> vpart;
+  std::unordered_map<std::string, size_t> mppart;                // part name -> vpart
+  std::unordered_map<std::string, std::vector<size_t>> mpref;    // chromosome -> vpart
+  std::unordered_map<std::string, std::vector<std::string>> mpinput;  // output prefix -> converted files
+
+  template <class T>
+  void setVal(MyOpt::Variables &values, const std::string &name, const T &val)
+  {
+    values.erase(name);
+    values.insert(std::make_pair(name, boost::program_options::variable_value(val, false)));
+  }
+
+  /* writes the table of the parts and the other chromosomes, or returns false when no chromosome is split */
+  bool splitGenomeTable(const std::string &filename, const std::string &splitfile, const int32_t binsize)
+  {
+    std::ifstream in(filename);
+    if (!in) PRINTERR_AND_EXIT("cannot open " << filename);
+
+    std::vector<std::pair<std::string, int64_t>> gt;
+    std::string lineStr;
+    while (!in.eof()) {
+      getline(in, lineStr);
+      if (lineStr.empty() || lineStr[0] == '#') continue;
+      std::vector<std::string> v;
+      boost::split(v, lineStr, boost::algorithm::is_any_of("\t"));
+      if (v.size() < 2) PRINTERR_AND_EXIT("invalid line in " << filename << ": " << lineStr);
+      gt.emplace_back(v[0], stoll(v[1]));
+    }
+
+    bool split(false);
+    for (auto &x: gt) if (x.second >= MAXLEN) split = true;
+    if (!split) return false;
+
+    int64_t partlen(PARTLEN / binsize * binsize);
+    std::ofstream out(splitfile);
+    if (!out) PRINTERR_AND_EXIT("cannot open " << splitfile);
+    for (auto &x: gt) {
+      if (x.second < MAXLEN) {
+        out << x.first << "\t" << x.second << std::endl;
+        continue;
+      }
+      for (int64_t base=0, k=1; base < x.second; base += partlen, ++k) {
+        std::string name(x.first + "_part" + std::to_string(k));
+        vpart.emplace_back(name, x.first, base, std::min(partlen, x.second - base), x.second);
+        mpref[rmchr(x.first)].emplace_back(vpart.size() -1);
+        out << name << "\t" << vpart.back().len << std::endl;
+      }
+    }
+    for (size_t i=0; i<vpart.size(); ++i) mppart[rmchr(vpart[i].name)] = i;
+    for (auto &x: gt) {
+      if (x.second < MAXLEN && mppart.count(rmchr(x.first))) PRINTERR_AND_EXIT(x.first << " in " << filename << " is also the name of a part of a long chromosome.");
+    }
+
+    std::cout << "Chromosomes of 2^31 bp or longer are read as parts of " << partlen << " bp (" << splitfile << ")." << std::endl;
+    return true;
+  }
+
+  /* the part (index of v) holding pos; positions beyond the chromosome go to the last part */
+  size_t getPartIndex(const std::vector<size_t> &v, const int64_t pos)
+  {
+    return std::min(static_cast<size_t>(std::max(pos, static_cast<int64_t>(0)) / vpart[v[0]].len), v.size() -1);
+  }
+
+  /* SAM/BAM/CRAM: written as BAM with the header of the parts */
+  void convertSam(const std::string &infile, const std::string &outfile, const int32_t nthreads)
+  {
+    samFile *in = sam_open(infile.c_str(), "r");
+    if (!in) PRINTERR_AND_EXIT("cannot open " << infile);
+    sam_hdr_t *hin = sam_hdr_read(in);
+    if (!hin) PRINTERR_AND_EXIT("cannot read the header of " << infile);
+
+    // the first target in the output and the parts of each target of the input
+    sam_hdr_t *hout = sam_hdr_init();
+    int32_t nref(sam_hdr_nref(hin));
+    std::vector<int32_t> vtid(nref);
+    std::vector<const std::vector<size_t> *> vparts(nref, nullptr);
+    int32_t ntid(0);
+    for (int32_t i=0; i<nref; ++i) {
+      std::string name(sam_hdr_tid2name(hin, i));
+      vtid[i] = ntid;
+      auto itr = mpref.find(rmchr(name));
+      if (itr == mpref.end()) {
+        sam_hdr_add_line(hout, "SQ", "SN", name.c_str(), "LN", std::to_string(sam_hdr_tid2len(hin, i)).c_str(), NULL);
+        ++ntid;
+        continue;
+      }
+      vparts[i] = &itr->second;
+      for (auto k: itr->second) {
+        sam_hdr_add_line(hout, "SQ", "SN", vpart[k].name.c_str(), "LN", std::to_string(vpart[k].len).c_str(), NULL);
+        ++ntid;
+      }
+    }
+
+    samFile *out = sam_open(outfile.c_str(), "wb");
+    if (!out) PRINTERR_AND_EXIT("cannot open " << outfile);
+    if (nthreads > 1) {
+      hts_set_threads(in, nthreads);
+      hts_set_threads(out, nthreads);
+    }
+    if (sam_hdr_write(out, hout) < 0) PRINTERR_AND_EXIT("cannot write " << outfile);
+
+    auto translate = [&] (int32_t &tid, hts_pos_t &pos) {
+      if (tid < 0) return;
+      int32_t id(tid);
+      tid = vtid[id];
+      if (!vparts[id]) return;
+      size_t k(getPartIndex(*vparts[id], pos));
+      tid += k;
+      pos -= vpart[(*vparts[id])[k]].base;
+    };
+
+    bam1_t *b = bam_init1();
+    int32_t ret(0);
+    while ((ret = sam_read1(in, hin, b)) >= 0) {
+      translate(b->core.tid, b->core.pos);
+      translate(b->core.mtid, b->core.mpos);
+      if (sam_write1(out, hout, b) < 0) PRINTERR_AND_EXIT("cannot write " << outfile);
+    }
+    if (ret < -1) PRINTERR_AND_EXIT("invalid record in " << infile);
+
+    bam_destroy1(b);
+    sam_hdr_destroy(hin);
+    sam_hdr_destroy(hout);
+    sam_close(in);
+    if (sam_close(out) < 0) PRINTERR_AND_EXIT("cannot write " << outfile);
+  }
+
+  /* TAGALIGN (chromosome, start, end, ...) and BOWTIE (name, strand, chromosome, position, ...) */
+  void convertText(const std::string &infile, const std::string &outfile, const int32_t colchr, const int32_t colend)
+  {
+    GzipStream in(infile);
+    std::ofstream out(outfile);
+    if (!out) PRINTERR_AND_EXIT("cannot open " << outfile);
+
+    std::string lineStr;
+    while (getline(in, lineStr)) {
+      std::vector<std::string> v;
+      boost::split(v, lineStr, boost::algorithm::is_any_of("\t"));
+      auto itr = (static_cast<int32_t>(v.size()) > colend) ? mpref.find(rmchr(v[colchr])) : mpref.end();
+      if (itr == mpref.end()) {
+        out << lineStr << "\n";
+        continue;
+      }
+      auto &part = vpart[itr->second[getPartIndex(itr->second, stoll(v[colchr +1]))]];
+      v[colchr] = part.name;
+      for (int32_t i=colchr +1; i<=colend; ++i) v[i] = std::to_string(stoll(v[i]) - part.base);
+      out << boost::algorithm::join(v, "\t") << "\n";
+    }
+  }
+}
+
+namespace SplitReference {
+  void setGenomeTable(MyOpt::Variables &values)
+  {
+    boost::mutex::scoped_lock lock(mtx);
+    std::string splitfile(MyOpt::getVal<std::string>(values, "odir") + "/"
+                          + boost::filesystem::path(MyOpt::getVal<std::string>(values, "gt")).filename().string() + ".split");
+    // the same table is used for all samples of --batch
+    if (!initialized) {
+      initialized = true;
+      gtfile = MyOpt::getVal<std::string>(values, "gt");
+      boost::filesystem::create_directory(MyOpt::getVal<std::string>(values, "odir"));
+      splitGenomeTable(gtfile, splitfile, MyOpt::getVal<int32_t>(values, "binsize"));
+    }
+    if (vpart.size()) setVal(values, "gt", splitfile);
+  }
+
+  void convertInput(MyOpt::Variables &values)
+  {
+    if (vpart.empty()) return;
+
+    std::string prefix(MyOpt::getVal<std::string>(values, "odir") + "/" + MyOpt::getVal<std::string>(values, "output"));
+    std::string ftype(values.count("ftype") ? boost::to_upper_copy(MyOpt::getVal<std::string>(values, "ftype")) : "");
+    int32_t nthreads(MyOpt::getVal<int32_t>(values, "threads"));
+
+    std::vector<std::string> vin, vout;
+    ParseLine(vin, MyOpt::getVal<std::string>(values, "input"), ',');
+    for (size_t i=0; i<vin.size(); ++i) {
+      std::string file(boost::to_lower_copy(vin[i]));
+      std::string outfile(prefix + ".split" + std::to_string(i+1));
+      std::cout << "Converting " << vin[i] << " to the parts of long chromosomes.." << std::flush;
+      if (ftype == "TAGALIGN" || (ftype == "" && isStr(file, ".tagalign"))) {
+        outfile += ".tagalign";
+        convertText(vin[i], outfile, 0, 2);
+      } else if (ftype == "BOWTIE" || (ftype == "" && isStr(file, ".bowtie"))) {
+        outfile += ".bowtie";
+        convertText(vin[i], outfile, 2, 3);
+      } else {
+        outfile += ".bam";
+        convertSam(vin[i], outfile, nthreads);
+        if (ftype != "") setVal(values, "ftype", std::string("BAM"));
+      }
+      std::cout << "done." << std::endl;
+      vout.emplace_back(outfile);
+    }
+    setVal(values, "input", boost::algorithm::join(vout, ","));
+
+    boost::mutex::scoped_lock lock(mtx);
+    mpinput[prefix] = vout;
+  }
+
+  void removeInput(const std::string &prefix)
+  {
+    boost::mutex::scoped_lock lock(mtx);
+    auto itr = mpinput.find(prefix);
+    if (itr == mpinput.end()) return;
+    for (auto &x: itr->second) remove(x.c_str());
+    mpinput.erase(itr);
+  }
+
+  bool isOn() { return vpart.size(); }
+
+  const Part * getPart(const std::string &name)
+  {
+    if (vpart.empty()) return nullptr;
+    auto itr = mppart.find(rmchr(name));
+    if (itr == mppart.end()) return nullptr;
+    return &vpart[itr->second];
+  }
+
+  std::vector<const Part *> getParts(const std::string &refname)
+  {
+    std::vector<const Part *> v;
+    auto itr = mpref.find(rmchr(refname));
+    if (itr == mpref.end()) return v;
+    for (auto k: itr->second) v.emplace_back(&vpart[k]);
+    return v;
+  }
+
+  const std::string & getGenomeTable() { return gtfile; }
+}
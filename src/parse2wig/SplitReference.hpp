@@ -0,0 +1,45 @@
+/* Copyright(c)  Ryuichiro Nakato <rnakato@iqb.u-tokyo.ac.jp>
+ * All rights reserved.
+ */
+#ifndef _SPLITREFERENCE_HPP_
+#define _SPLITREFERENCE_HPP_
+
+#include <string>
+#include <vector>
+#include "../submodules/SSP/common/BoostOptions.hpp"
+
+/* Chromosomes of 2^31 bp or longer in the genome table.
+ * Reads are stored with 32-bit positions (SSP Read), so each of these chromosomes is read as parts
+ * (<name>_part1, <name>_part2, ...) whose reads are held by their offset from the part start.
+ * The parts are multiples of the bin size, so the bins of a chromosome are those of its parts in order.
+ * The output and the per-chromosome reference data (mappability, genome sequence, BED regions)
+ * are translated back to the chromosome and the position base + offset. */
+namespace SplitReference {
+  class Part {
+  public:
+    std::string name;     // in the genome table given to the reader
+    std::string refname;  // in the input genome table
+    int64_t base;         // start of the part in the chromosome
+    int64_t len;
+    int64_t reflen;
+    Part(const std::string &n, const std::string &r, const int64_t b, const int64_t l, const int64_t rl):
+      name(n), refname(r), base(b), len(l), reflen(rl) {}
+    bool islast() const { return base + len == reflen; }
+  };
+
+  /* replaces "gt" with the table of the parts when the genome table has long chromosomes */
+  void setGenomeTable(MyOpt::Variables &values);
+  /* replaces "input" with the input converted to the parts (removed by removeInput) */
+  void convertInput(MyOpt::Variables &values);
+  void removeInput(const std::string &prefix);
+
+  bool isOn();
+  /* nullptr for a chromosome that is not a part (the name may have "chr") */
+  const Part * getPart(const std::string &name);
+  /* the parts of a chromosome of the input genome table (empty: not split) */
+  std::vector<const Part *> getParts(const std::string &refname);
+  /* the input genome table, for the output by chromosome */
+  const std::string & getGenomeTable();
+}
+
+#endif /* _SPLITREFERENCE_HPP_ */
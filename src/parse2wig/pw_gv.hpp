@@ -10,6 +10,13 @@
 #include "GenomeCoverage.hpp"
 #include "GCnormalization.hpp"
 #include "ReadMpbldata.hpp"
+#include "ShiftProfileSampling.hpp"
+#include "RedundantReads.hpp"
+#include "ReadPartition.hpp"
+#include "ReadFilter.hpp"
+#include "SpikeIn.hpp"
+#include "RegionCount.hpp"
+#include "ContigGroup.hpp"
 #include "../submodules/SSP/src/MThread.hpp"
 #include "../submodules/SSP/src/LibraryComplexity.hpp"
 #include "../submodules/SSP/src/ShiftProfile.hpp"
@@ -21,22 +28,26 @@ namespace RPM {
     std::string ntype;
     int32_t nrpm;
     double ndepth;
+    int32_t nspike;
 
   public:
     Pnorm():
       opt("Total Read normalization",100),
-      nrpm(0), ndepth(0)
+      nrpm(0), ndepth(0), nspike(0)
     {
       opt.add_options()
 	("ntype,n",
 	 boost::program_options::value<std::string>()->default_value("NONE"),
-	 "Total read normalization\n{NONE|GR|GD|CR|CD}\n   NONE: not normalize\n   GR: for whole genome, read number\n   GD: for whole genome, read depth\n   CR: for each chromosome, read number\n   CD: for each chromosome, read depth")
+	 "Total read normalization\n{NONE|GR|GD|CR|CD}\n   NONE: not normalize\n   GR: for whole genome, read number\n   GD: for whole genome, read depth\n   CR: for each chromosome, read number\n   CD: for each chromosome, read depth\n   SP: spike-in reads (with --spikein)")
 	("nrpm",
 	 boost::program_options::value<int32_t>()->default_value(2*NUM_10M)->notifier(std::bind(&MyOpt::over<int32_t>, std::placeholders::_1, 0, "--nrpm")),
 	 "(For GR|CR) Total read number after normalization")
 	("ndepth",
 	 boost::program_options::value<double>()->default_value(1.0)->notifier(std::bind(&MyOpt::over<double>, std::placeholders::_1, 0, "--ndepth")),
 	 "(For GD|CD) Averaged read depth after normalization")
+	("nspike",
+	 boost::program_options::value<int32_t>()->default_value(NUM_1M)->notifier(std::bind(&MyOpt::over<int32_t>, std::placeholders::_1, 1, "--nspike")),
+	 "(For SP) Spike-in read number after normalization")
 	;
     }
 
@@ -50,7 +61,9 @@ namespace RPM {
       ntype  = MyOpt::getVal<std::string>(values, "ntype");
       nrpm   = MyOpt::getVal<int32_t>(values, "nrpm");
       ndepth = MyOpt::getVal<double>(values, "ndepth");
-      if(ntype != "NONE" && ntype != "GR" && ntype != "GD" && ntype != "CR" && ntype != "CD") PRINTERR_AND_EXIT("invalid --ntype.\n");
+      nspike = MyOpt::getVal<int32_t>(values, "nspike");
+      if(ntype != "NONE" && ntype != "GR" && ntype != "GD" && ntype != "CR" && ntype != "CD" && ntype != "SP") PRINTERR_AND_EXIT("invalid --ntype.\n");
+      if(ntype == "SP" && !values.count("spikein")) PRINTERR_AND_EXIT("--ntype SP requires --spikein.\n");
 
       DEBUGprint_FUNCend();
     }
@@ -62,11 +75,15 @@ namespace RPM {
       else if(ntype == "GD" || ntype == "CD"){
 	std::cout << "\tnormed depth: " << ndepth << std::endl;
       }
+      else if(ntype == "SP"){
+	std::cout << "\tnormed spike-in read: " << nspike << std::endl;
+      }
     }
 
     const std::string & getType() const { return ntype; }
     int32_t getnrpm()  const { return nrpm; }
     double getndepth() const { return ndepth; }
+    int32_t getnspike() const { return nspike; }
   };
 }
 
@@ -95,13 +112,20 @@ class Mapfile: private Uncopyable {
  public:
   SeqStatsGenome genome;
   WigStatsGenome wsGenome;
+  ReadPartition partition;
   RPM::Pnorm rpm;
   GenomeCov::Genome gcov;
   GCnorm gc;
 
   // for SSP
   SSPstats sspst;
-  LibComp complexity;
+  LibComp complexity;  // defines the options of the redundant read filter
+  RedundantReadFilter redundant;
+  Downsampling downsampling;
+  Blacklist blacklist;
+  SpikeIn spikein;
+  RegionCount regioncount;
+  ShiftProfileSampling fastflen;
 
   Mapfile():
     opt("Input annotations",100),
@@ -128,9 +152,15 @@ class Mapfile: private Uncopyable {
   void setOpts(MyOpt::Opts &allopts) {
     genome.setOpts(allopts);
     wsGenome.setOpts(allopts);
+    partition.setOpts(allopts);
     rpm.setOpts(allopts);
     complexity.setOpts(allopts);
+    downsampling.setOpts(allopts);
+    blacklist.setOpts(allopts);
+    spikein.setOpts(allopts);
+    regioncount.setOpts(allopts);
     sspst.setOpts(allopts);
+    fastflen.setOpts(allopts);
     allopts.add(opt);
     gc.setOpts(allopts);
   }
@@ -147,6 +177,11 @@ class Mapfile: private Uncopyable {
       printf("Correcting GC bias:\n");
       std::cout << "\tChromosome directory: " << gc.getGCdir() << std::endl;
     }
+    partition.dump();
+    downsampling.dump();
+    blacklist.dump();
+    spikein.dump();
+    regioncount.dump();
   }
 
   int32_t getIdLongestChr () const { return id_longestChr; }
@@ -162,12 +197,29 @@ class Mapfile: private Uncopyable {
 
   void calcGenomeCoverage() {
     std::cout << "Calculate genome coverage.." << std::flush;
+    if (mpdir == "") std::cout << "Mappability file is not specified. All genomeic regions are considered as mappable." << std::endl;
+    else std::cout << "Reading binary mappability file.." << std::flush;
 
     gcov.setr4cmp(genome.getnread_nonred(Strand::BOTH), genome.getnread_inbed());
-
-    for(size_t i=0; i<genome.getnchr(); i++) {
-      auto array = GenomeCov::makeGcovArray(*this, genome.chr[i], gcov.getr4cmp());
-      gcov.chr.emplace_back(array, gcov.getlackOfRead());
+    std::mt19937 mt(gcov.getRandomGenerator());
+
+    // one buffer is reused for all chromosomes
+    std::vector<BpStatus> array;
+    for (auto &group: ContigGroup::getGroups(genome.chr)) {
+      for (int32_t i=group.s; i<=group.e; ++i) {
+        // spike-in chromosomes are not counted in the genome coverage
+        if (spikein.isSpikein(i)) {
+          gcov.chr.emplace_back(0, gcov.getlackOfRead());
+          continue;
+        }
+        // contigs without reads skip the mappability file and take the mappable length of the genome table
+        if (!genome.chr[i].getnread_nonred(Strand::BOTH)) {
+          gcov.chr.emplace_back(genome.chr[i].getlenmpbl(), gcov.getlackOfRead());
+          continue;
+        }
+        GenomeCov::makeGcovArray(*this, genome.chr[i], gcov.getr4cmp(), mt, array);
+        gcov.chr.emplace_back(array, gcov.getlackOfRead());
+      }
     }
     std::cout << "done." << std::endl;
   }
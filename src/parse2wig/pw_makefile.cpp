@@ -1,12 +1,48 @@
 /* Copyright(c)  Ryuichiro Nakato <rnakato@iqb.u-tokyo.ac.jp>
  * All rights reserved.
  */
+#include <cmath>
+#include <algorithm>
 #include "pw_makefile.hpp"
 #include "pw_gv.hpp"
 #include "WigStats.hpp"
 #include "ReadMpbldata.hpp"
+#include "ContigGroup.hpp"
+#include "SplitReference.hpp"
 #include "../submodules/SSP/src/SeqStats.hpp"
 
+/* the regions [s, e] of a read that are added to the wig: the fragment, its center (--rcenter)
+   or the two read ends (--onlyreadregion), clamped to the chromosome.
+   Returns the number of regions (0-2). */
+int32_t getReadRegion(const WigStatsGenome &p, const Read &x, const int64_t chrlen,
+                      const int32_t readlenF3, const int32_t readlenF5, int64_t (&s)[2], int64_t (&e)[2])
+{
+  int64_t fs(std::min(x.F3, x.F5));
+  int64_t fe(std::max(x.F3, x.F5));
+
+  int32_t rcenter(p.getrcenter());
+  if (rcenter) {  // consider only center region of fragments
+    fs = (fs + fe - rcenter)/2;
+    fe = fs + rcenter;
+  }
+  fs = std::max(static_cast<int64_t>(0), fs);
+  fe = std::min(fe, chrlen -1);
+
+  int32_t n(0);
+  auto add = [&] (const int64_t start, const int64_t end) {
+    s[n] = std::max(static_cast<int64_t>(0), start);
+    e[n] = std::min(end, chrlen -1);
+    if (s[n] <= e[n]) ++n;
+  };
+  if (p.isonlyreadregion() && (fe-fs) > 300) { // for paired-end: consider only read region
+    add(fs, fs + readlenF3 -1);
+    add(fe - readlenF5 +1, fe);
+  } else {
+    add(fs, fe);
+  }
+  return n;
+}
+
 namespace {
   void printwarning(double w)
   {
@@ -18,56 +54,28 @@ namespace {
 
   void addReadToWigArray(const WigStatsGenome &p, WigArray &wigarray, const Read x, const int64_t chrlen, const int32_t readlenF3, const int32_t readlenF5)
   {
-    int32_t s, e;
-    s = std::min(x.F3, x.F5);
-    e = std::max(x.F3, x.F5);
-
-    int32_t rcenter(p.getrcenter());
-    if (rcenter) {  // consider only center region of fragments
-      s = (s + e - rcenter)/2;
-      e = s + rcenter;
-    }
-    s = std::max(0, s);
-    e = std::min(e, (int32_t)(chrlen -1));
-
-    if (p.isonlyreadregion() && (e-s) > 300) { // for paired-end: consider only read region
-      int32_t sbin(s/p.getbinsize());
-      int32_t ebin((e+readlenF3)/p.getbinsize());
-      for (int32_t j=sbin; j<=ebin; ++j) wigarray.addval(j, x.getWeight());
-      sbin = (e-readlenF5)/p.getbinsize();
-      ebin = e/p.getbinsize();
-      for (int32_t j=sbin; j<=ebin; ++j) wigarray.addval(j, x.getWeight());
-    } else {
-      int32_t sbin(s/p.getbinsize());
-      int32_t ebin(e/p.getbinsize());
-      for (int32_t j=sbin; j<=ebin; ++j) wigarray.addval(j, x.getWeight());
+    int64_t s[2], e[2];
+    int32_t n(getReadRegion(p, x, chrlen, readlenF3, readlenF5, s, e));
+    for (int32_t i=0; i<n; ++i) {
+      int64_t sbin(s[i]/p.getbinsize());
+      int64_t ebin(e[i]/p.getbinsize());
+      for (int64_t j=sbin; j<=ebin; ++j) wigarray.addval(j, x.getWeight());
     }
     return;
   }
 
+  /* the genome-wide weight (GR, GD, SP) is reported once per sample by printGenomeScaleWeight() */
   double getScaleWeight_for_totalreads(Mapfile &p, const SeqStats &chr)
   {
-    static int32_t on(0);
     double w(0);
     std::string ntype(p.rpm.getType());
 
     if (ntype == "GR") {
-      double dn(p.genome.getnread_nonred(Strand::BOTH));
-      w = getratio(p.rpm.getnrpm(), dn);
-      if (!on) {
-        std::cout << boost::format("\ngenomic read number = %1%, after=%2%, w=%3$.3f\n") % (int64_t)dn % p.rpm.getnrpm() % w;
-        if (w>2) printwarning(w);
-        on=1;
-      }
+      w = getratio(p.rpm.getnrpm(), p.genome.getnread_nonred(Strand::BOTH));
     } else if (ntype == "GD") {
       w = getratio(p.rpm.getndepth(), p.genome.getdepth());
-      if (!on) {
-        std::cout << boost::format("\ngenomic depth = %1$.2f, after=%2$.2f, w=%3$.3f\n") % p.genome.getdepth() % p.rpm.getndepth() % w;
-        if (w>2) printwarning(w);
-        on=1;
-      }
     } else if (ntype == "CR") {
-      double nm = p.rpm.getnrpm() * getratio(chr.getlenmpbl(), p.genome.getlenmpbl());
+      double nm = p.rpm.getnrpm() * getratio(chr.getlenmpbl(), p.genome.getlenmpbl() - p.spikein.getlenmpbl(p.genome));
       double dn = chr.getnread_nonred(Strand::BOTH);
       w = getratio(nm, dn);
       std::cout << boost::format("read number = %1%, after=%2$.1f, w=%3$.3f\n") % static_cast<int64_t>(dn) % nm % w;
@@ -76,48 +84,86 @@ namespace {
       w = getratio(p.rpm.getndepth(), chr.getdepth());
       std::cout << boost::format("depth = %1$.2f, after=%2$.2f, w=%3$.3f\n") % chr.getdepth() % p.rpm.getndepth() % w;
       if (w>2) printwarning(w);
+    } else if (ntype == "SP") {
+      w = getratio(p.rpm.getnspike(), p.spikein.getnread_spike());
     }
 
     return w;
   }
 
-  WigArray count_and_normalize_Wigarray(Mapfile &p, const int32_t id)
+  void printGenomeScaleWeight(const Mapfile &p)
+  {
+    std::string ntype(p.rpm.getType());
+
+    if (ntype == "GR") {
+      double dn(p.genome.getnread_nonred(Strand::BOTH));
+      double w(getratio(p.rpm.getnrpm(), dn));
+      std::cout << boost::format("genomic read number = %1%, after=%2%, w=%3$.3f\n") % (int64_t)dn % p.rpm.getnrpm() % w;
+      if (w>2) printwarning(w);
+    } else if (ntype == "GD") {
+      double w(getratio(p.rpm.getndepth(), p.genome.getdepth()));
+      std::cout << boost::format("genomic depth = %1$.2f, after=%2$.2f, w=%3$.3f\n") % p.genome.getdepth() % p.rpm.getndepth() % w;
+      if (w>2) printwarning(w);
+    } else if (ntype == "SP") {
+      double dn(p.spikein.getnread_spike());
+      double w(getratio(p.rpm.getnspike(), dn));
+      std::cout << boost::format("spike-in read number = %1%, after=%2%, w=%3$.3f\n") % (int64_t)dn % p.rpm.getnspike() % w;
+    }
+  }
+
+  /* vwig: the array of all reads followed by those of the read partitions (--partition).
+     The buffers are shared among the chromosomes. */
+  void count_and_normalize_Wigarray(Mapfile &p, const int32_t id, std::vector<WigArray> &vwig, double &wtotal)
   {
-    std::cout << "chr" << p.genome.chr[id].getname() << ".." << std::flush;
-    WigArray wigarray(p.wsGenome.chr[id].getnbin(), 0);
+    vwig.resize(p.partition.size() +1);
+    for (auto &wigarray: vwig) wigarray.reset(p.wsGenome.chr[id].getnbin());
 
     // Convert readarray to Wig
+    bool hasread(false);
     for (auto strand: {Strand::FWD, Strand::REV}) {
       for (auto &x: p.genome.chr[id].getvReadref(strand)) {
         if (x.duplicate) continue;
-        addReadToWigArray(p.wsGenome, wigarray, x, p.genome.chr[id].getlen(), p.genome.dflen.getlenF3(), p.genome.dflen.getlenF5());
+        hasread = true;
+        addReadToWigArray(p.wsGenome, vwig[0], x, p.genome.chr[id].getlen(), p.genome.dflen.getlenF3(), p.genome.dflen.getlenF5());
+        if (!p.partition.isOn()) continue;
+        int32_t part(p.partition.getPartition(x, strand));
+        if (part < 0) continue;
+        addReadToWigArray(p.wsGenome, vwig[part+1], x, p.genome.chr[id].getlen(), p.genome.dflen.getlenF3(), p.genome.dflen.getlenF5());
+        p.partition.addRead(part, id);
       }
     }
 
-    // Mappability normalization
-    if (p.getMpblBinaryDir() != "") {
+    // Mappability normalization (not needed for empty contigs)
+    if (p.getMpblBinaryDir() != "" && hasread) {
       int32_t binsize(p.wsGenome.getbinsize());
       int32_t mpthre = p.getmpthre() * binsize;
       auto mparray = readMpblWigArray(p.getMpblBinaryDir(),
                                       ("chr" + p.genome.chr[id].getname()),
                                       binsize,
                                       p.wsGenome.chr[id].getnbin());
-      for (int32_t i=0; i<p.wsGenome.chr[id].getnbin(); ++i) {
+      for (int64_t i=0; i<p.wsGenome.chr[id].getnbin(); ++i) {
         //      std::cout << "mparray[i]: " << mparray[i] << std::endl;
-        if (mparray[i] > mpthre) wigarray.multipleval(i, getratio(binsize, mparray[i]));
+        if (mparray[i] > mpthre) {
+          for (auto &wigarray: vwig) wigarray.multipleval(i, getratio(binsize, mparray[i]));
+        }
       }
     }
 
     /* Total read normalization */
+    wtotal = 1;
     if (p.rpm.getType() != "NONE") {
       double w = getScaleWeight_for_totalreads(p, p.genome.chr[id]);
+      wtotal = w;
       p.genome.setsizefactor(w, id);
-      if (p.rpm.getType() == "GR" || p.rpm.getType() == "GD") p.genome.setsizefactor(w);
+      if (p.rpm.getType() == "GR" || p.rpm.getType() == "GD" || p.rpm.getType() == "SP") p.genome.setsizefactor(w);
 
-      for (int32_t i=0; i<p.wsGenome.chr[id].getnbin(); ++i) { wigarray.multipleval(i, w); }
+      for (auto &wigarray: vwig) {
+        for (int64_t i=0; i<p.wsGenome.chr[id].getnbin(); ++i) { wigarray.multipleval(i, w); }
+      }
     }
 
-    p.wsGenome.setWigStats(id, wigarray);
+    p.wsGenome.setWigStats(id, vwig[0]);
+    for (size_t i=0; i<p.partition.size(); ++i) p.partition.setWigStats(i, id, vwig[i+1]);
 
     // Peak calling
     /*  t1 = clock();
@@ -126,108 +172,242 @@ namespace {
         t2 = clock();
         PrintTime(t1, t2, "peakcall");*/
 
-    return wigarray;
+    return;
   }
 
-  void outputWig(Mapfile &p, const std::string &filename)
+  /* For --bpres: the coverage is a step function that changes only at fragment ends.
+     Each fragment adds +weight at its start and -weight after its end,
+     and the sorted boundaries are swept once to output the runs of constant value. */
+  class CoverageEdge {
+  public:
+    int64_t pos;
+    int64_t val;
+    CoverageEdge(const int64_t p, const int64_t v): pos(p), val(v) {}
+    bool operator<(const CoverageEdge &x) const { return pos < x.pos; }
+  };
+
+  enum {BPRES_GETA=10000};  // fixed point as in WigArray
+
+  void addReadToEdges(const WigStatsGenome &p, std::vector<CoverageEdge> &vedge, const Read &x, const int64_t chrlen, const int32_t readlenF3, const int32_t readlenF5)
   {
-    int32_t binsize(p.wsGenome.getbinsize());
+    int64_t w(llround(x.getWeight() * BPRES_GETA));
+    int64_t s[2], e[2];
+    int32_t n(getReadRegion(p, x, chrlen, readlenF3, readlenF5, s, e));
+    for (int32_t i=0; i<n; ++i) {
+      vedge.emplace_back(s[i], w);
+      vedge.emplace_back(e[i]+1, -w);
+    }
+  }
 
-    FILE* File = fopen(filename.c_str(), "w");
+  void printBpResLine(FILE *File, const std::string &name, const int64_t s, const int64_t e, const double val)
+  {
+    if (val == std::floor(val)) fprintf(File, "%s\t%ld\t%ld\t%.0f\n", name.c_str(), s, e, val);
+    else                        fprintf(File, "%s\t%ld\t%ld\t%.3f\n", name.c_str(), s, e, val);
+  }
 
-    fprintf(File, "track type=wiggle_0\tname=\"%s\"\tdescription=\"Merged tag counts for every %d bp\"\n", p.getSampleName().c_str(), binsize);
+  void outputBpResBedGraph(Mapfile &p, const int32_t id, FILE *File, const double wtotal)
+  {
+    auto &chr = p.genome.chr[id];
+    int64_t chrlen(chr.getlen());
+    // a part of a split chromosome is output at base + offset of the chromosome
+    auto part = SplitReference::getPart(chr.getname());
+    std::string name(part ? part->refname : chr.getrefname());
+    int64_t base(part ? part->base : 0);
+    bool outputzero(p.wsGenome.isoutputzero());
 
-    for (size_t i=0; i<p.genome.getnchr(); ++i) {
-      WigArray array = count_and_normalize_Wigarray(p, i);
+    std::vector<CoverageEdge> vedge;
+    for (auto strand: {Strand::FWD, Strand::REV}) {
+      for (auto &x: chr.getvReadref(strand)) {
+        if (x.duplicate) continue;
+        addReadToEdges(p.wsGenome, vedge, x, chrlen, p.genome.dflen.getlenF3(), p.genome.dflen.getlenF5());
+      }
+    }
+    std::sort(vedge.begin(), vedge.end());
 
-      fprintf(File, "variableStep\tchrom=%s\tspan=%d\n", p.genome.chr[i].getrefname().c_str(), binsize);
-      bool isfloat(false);
-      array.outputAsWig(File, binsize, p.wsGenome.isoutputzero(), isfloat);
+    int64_t start(0);
+    int64_t cur(0);
+    size_t i(0);
+    while (i < vedge.size()) {
+      int64_t pos(vedge[i].pos);
+      int64_t next(cur);
+      while (i < vedge.size() && vedge[i].pos == pos) next += vedge[i++].val;
+      if (next == cur) continue;  // merge the adjacent runs with the same value
+      if (pos > start && (cur || outputzero)) printBpResLine(File, name, base + start, base + pos, cur * wtotal / BPRES_GETA);
+      start = pos;
+      cur = next;
     }
-    fclose(File);
+    if (chrlen > start && (cur || outputzero)) printBpResLine(File, name, base + start, base + chrlen, cur * wtotal / BPRES_GETA);
 
     return;
   }
 
-  void outputBedGraph(Mapfile &p, const std::string &filename)
+  /* output file of all reads (first) or of a read partition */
+  class Track {
+  public:
+    std::string filename;
+    std::string name;
+    Track(const std::string &f, const std::string &n): filename(f), name(n) {}
+  };
+
+  void outputWig(Mapfile &p, const std::vector<Track> &vtrack)
   {
     int32_t binsize(p.wsGenome.getbinsize());
-    std::ofstream out(filename);
-    out << boost::format("browser position %1%:%2%-%3%\n") % p.genome.chr[0].getrefname() % 0 % (p.genome.chr[0].getlen()/100);
-    out << "browser hide all" << std::endl;
-    out << "browser pack refGene encodeRegions" << std::endl;
-    out << "browser full altGraph" << std::endl;
-    out << boost::format("track type=bedGraph name=\"%1%\" description=\"Merged tag counts for every %2% bp\" visibility=full\n")
-      % p.getSampleName() % binsize;
-    out.close();
 
-    std::string tempfile = filename + ".tmpfile";
+    std::vector<FILE*> vFile;
+    for (auto &x: vtrack) {
+      FILE* File = fopen(x.filename.c_str(), "w");
+      fprintf(File, "track type=wiggle_0\tname=\"%s\"\tdescription=\"Merged tag counts for every %d bp\"\n", x.name.c_str(), binsize);
+      vFile.emplace_back(File);
+    }
 
-    FILE* File = fopen(tempfile.c_str(), "w");
+    std::vector<WigArray> vwig;
+    for (auto &group: ContigGroup::getGroups(p.genome.chr)) {
+      std::cout << group.getlabel(p.genome.chr) << ".." << std::flush;
+      for (int32_t i=group.s; i<=group.e; ++i) {
+        if (p.spikein.isSpikein(i)) continue;
+        double wtotal(0);
+        count_and_normalize_Wigarray(p, i, vwig, wtotal);
+
+        // a part of a split chromosome continues the block of the chromosome, without the bin after its end
+        auto part = SplitReference::getPart(p.genome.chr[i].getname());
+        size_t nbin(part && !part->islast() ? part->len / binsize : 0);
+        for (size_t j=0; j<vFile.size(); ++j) {
+          if (!part || !part->base) {
+            fprintf(vFile[j], "variableStep\tchrom=%s\tspan=%d\n", (part ? part->refname : p.genome.chr[i].getrefname()).c_str(), binsize);
+          }
+          bool isfloat(false);
+          vwig[j].outputAsWig(vFile[j], binsize, p.wsGenome.isoutputzero(), isfloat, part ? part->base : 0, nbin);
+        }
+      }
+    }
+    for (auto File: vFile) fclose(File);
+
+    return;
+  }
+
+  void outputBedGraph(Mapfile &p, const std::vector<Track> &vtrack)
+  {
+    int32_t binsize(p.wsGenome.isbpres() ? 1 : p.wsGenome.getbinsize());
+
+    std::vector<FILE*> vFile;
+    for (auto &x: vtrack) {
+      std::ofstream out(x.filename);
+      out << boost::format("browser position %1%:%2%-%3%\n") % p.genome.chr[0].getrefname() % 0 % (p.genome.chr[0].getlen()/100);
+      out << "browser hide all" << std::endl;
+      out << "browser pack refGene encodeRegions" << std::endl;
+      out << "browser full altGraph" << std::endl;
+      out << boost::format("track type=bedGraph name=\"%1%\" description=\"Merged tag counts for every %2% bp\" visibility=full\n")
+        % x.name % binsize;
+      out.close();
+
+      std::string tempfile = x.filename + ".tmpfile";
+      vFile.emplace_back(fopen(tempfile.c_str(), "w"));
+    }
 
     clock_t t1,t2;
-    for (size_t i=0; i<p.genome.getnchr(); ++i) {
-      t1 = clock();
-      WigArray array = count_and_normalize_Wigarray(p, i);
-      t2 = clock();
-      PrintTime(t1, t2, "count_and_normalize_Wigarray");
+    std::vector<WigArray> vwig;
+    for (auto &group: ContigGroup::getGroups(p.genome.chr)) {
+      std::cout << group.getlabel(p.genome.chr) << ".." << std::flush;
       t1 = clock();
-      bool isfloat(false);
-      array.outputAsBedGraph(File,
-                             binsize,
-                             p.genome.chr[i].getrefname(),
-                             p.genome.chr[i].getlen() -1,
-                             p.wsGenome.isoutputzero(),
-                             isfloat);
+      for (int32_t i=group.s; i<=group.e; ++i) {
+        if (p.spikein.isSpikein(i)) continue;
+        double wtotal(0);
+        count_and_normalize_Wigarray(p, i, vwig, wtotal);
+        if (p.wsGenome.isbpres()) {
+          outputBpResBedGraph(p, i, vFile[0], wtotal);
+          continue;
+        }
+        auto part = SplitReference::getPart(p.genome.chr[i].getname());
+        for (size_t j=0; j<vFile.size(); ++j) {
+          bool isfloat(false);
+          vwig[j].outputAsBedGraph(vFile[j],
+                                   binsize,
+                                   part ? part->refname : p.genome.chr[i].getrefname(),
+                                   p.genome.chr[i].getlen() -1,
+                                   p.wsGenome.isoutputzero(),
+                                   isfloat,
+                                   part ? part->base : 0);
+        }
+      }
       t2 = clock();
-      PrintTime(t1, t2, "outputAsBedGraph");
+      PrintTime(t1, t2, "count_and_output");
     }
-    fclose (File);
+    for (auto File: vFile) fclose(File);
 
     printf("sort bedGraph...\n");
-    std::string command = "sort -k1,1 -k2,2n "+ tempfile +" >> " + filename;
-    if (system(command.c_str())) PRINTERR_AND_EXIT("sorting bedGraph failed.");
-
-    remove(tempfile.c_str());
+    for (auto &x: vtrack) {
+      std::string tempfile = x.filename + ".tmpfile";
+      std::string command = "sort -k1,1 -k2,2n "+ tempfile +" >> " + x.filename;
+      if (system(command.c_str())) PRINTERR_AND_EXIT("sorting bedGraph failed.");
+      remove(tempfile.c_str());
+    }
 
     return;
   }
 
+  void convertToBigWig(const std::string &bedGraph, const std::string &genometable, const std::string &bigWig)
+  {
+    std::string command = "bedGraphToBigWig " + bedGraph + " " + genometable + " " + bigWig;
+    if (system(command.c_str())) {
+      std::cerr << "Error: command " << command << "return nonzero status. "
+                << "Add the PATH to 'DROMPAplus/otherbins'." << std::endl;
+    }
+  }
+
 }
 void generate_wigfile(Mapfile &p)
 {
   printf("Convert read data to array: \n");
   WigType oftype(p.wsGenome.getWigType());
-  std::string filename(p.getbinprefix());
+  printGenomeScaleWeight(p);
+  if (p.partition.isOn()) p.partition.initWigStats(p.wsGenome);
 
+  // --bpres: the binned array is still built for the statistics
+  std::vector<std::string> vprefix;
+  std::vector<std::string> vname;
+  vprefix.emplace_back(p.wsGenome.isbpres() ? p.getprefix() + ".1" : p.getbinprefix());
+  vname.emplace_back(p.getSampleName());
+  for (size_t i=0; i<p.partition.size(); ++i) {
+    vprefix.emplace_back(p.getprefix() + "." + p.partition.getlabel(i) + "." + std::to_string(p.wsGenome.getbinsize()));
+    vname.emplace_back(p.getSampleName() + "." + p.partition.getlabel(i));
+  }
+
+  std::vector<Track> vtrack;
   if (oftype==WigType::COMPRESSWIG || oftype==WigType::UNCOMPRESSWIG) {
-    filename += ".wig";
-    outputWig(p, filename);
+    for (size_t i=0; i<vprefix.size(); ++i) vtrack.emplace_back(vprefix[i] + ".wig", vname[i]);
+    outputWig(p, vtrack);
     if (oftype==WigType::COMPRESSWIG) {
-      std::string command = "gzip -f " + filename;
-      if (system(command.c_str())) PRINTERR_AND_EXIT("gzip .wig failed.");
+      for (auto &x: vtrack) {
+        std::string command = "gzip -f " + x.filename;
+        if (system(command.c_str())) PRINTERR_AND_EXIT("gzip .wig failed.");
+      }
     }
   } else if (oftype==WigType::BEDGRAPH) {
-    filename += ".bedGraph";
-    outputBedGraph(p, filename);
+    for (size_t i=0; i<vprefix.size(); ++i) vtrack.emplace_back(vprefix[i] + ".bedGraph", vname[i]);
+    outputBedGraph(p, vtrack);
   } else if (oftype==WigType::BIGWIG) {
-    int32_t fd(0);
-    char tmpfile[] = "/tmp/parse2wig+_bedGraph_XXXXXX";
-    if ((fd = mkstemp(tmpfile)) < 0){
-      perror("mkstemp");
-      //      fd = EXIT_FAILURE;
+    for (size_t i=0; i<vprefix.size(); ++i) {
+      int32_t fd(0);
+      char tmpfile[] = "/tmp/parse2wig+_bedGraph_XXXXXX";
+      if ((fd = mkstemp(tmpfile)) < 0){
+        perror("mkstemp");
+        //      fd = EXIT_FAILURE;
+      }
+      close(fd);
+      vtrack.emplace_back(tmpfile, vname[i]);
     }
-    outputBedGraph(p, std::string(tmpfile));
+    outputBedGraph(p, vtrack);
     printf("Convert to bigWig...\n");
-    std::string command = "bedGraphToBigWig " + std::string(tmpfile) + " " + p.genome.getGenomeTable() + " " + p.getbinprefix() + ".bw";
-    if (system(command.c_str())) {
-      unlink(tmpfile);
-      std::cerr << "Error: command " << command << "return nonzero status. "
-                << "Add the PATH to 'DROMPAplus/otherbins'." << std::endl;
+    for (size_t i=0; i<vtrack.size(); ++i) {
+      // the chromosomes in the output are those of the input genome table
+      std::string gt(SplitReference::isOn() ? SplitReference::getGenomeTable() : p.genome.getGenomeTable());
+      convertToBigWig(vtrack[i].filename, gt, vprefix[i] + ".bw");
+      unlink(vtrack[i].filename.c_str());
     }
-    unlink(tmpfile);
   }
 
+  if (p.partition.isOn()) p.partition.outputStats(p.getbinprefix() + ".partition.tsv", p.genome);
+
   printf("done.\n");
   return;
 }
@@ -4,7 +4,13 @@
 #ifndef _PW_MAKEFILE_HPP_
 #define _PW_MAKEFILE_HPP_
 
+#include <cstdint>
+
 class Mapfile;
+class WigStatsGenome;
+class Read;
 void generate_wigfile(Mapfile &);
+int32_t getReadRegion(const WigStatsGenome &p, const Read &x, const int64_t chrlen,
+                      const int32_t readlenF3, const int32_t readlenF5, int64_t (&s)[2], int64_t (&e)[2]);
 
 #endif /* _PW_MAKEFILE_HPP_ */
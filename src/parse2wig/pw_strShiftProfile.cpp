@@ -2,6 +2,7 @@
  * All rights reserved.
  */
 #include "SeqStatsDROMPA.hpp"
+#include "ShiftProfileSampling.hpp"
 #include "../submodules/SSP/src/ShiftProfile.hpp"
 #include "../submodules/SSP/src/ShiftProfile_p.hpp"
 
@@ -62,3 +63,24 @@ void SeqStatsGenome::strShiftProfile(SSPstats &sspst, const std::string &head, c
   DEBUGprint("strShiftProfileDROMPA done.");
   return;
 }
+
+void SeqStatsGenome::strShiftProfileSampling(SSPstats &sspst, ShiftProfileSampling &sampling, const std::string &head, const bool verbose)
+{
+  DEBUGprint("strShiftProfileSampling...");
+
+  std::cout << "Fast fragment length estimation by sampled windows..." << std::endl;
+  sampling.estimate(chr, sspst.getNgFrom(), sspst.getNgTo(), sspst.getNgStep(), dflen.getlenF3());
+
+  dflen.setflen_ssp(sampling.getflen());
+
+  std::cout << boost::format("\nEstimated fragment length: %1% (95%% CI %2%-%3%, %4% windows)\n")
+    % sampling.getflen() % sampling.getCIlow() % sampling.getCIhigh() % sampling.getnwin();
+
+  if(verbose) {
+    sampling.outputProfile(head + ".jaccard.sampling.tsv");
+    setSSPstats(sspst, sampling.getbackgroundUniformity(), sampling.getnsc(), sampling.getrlsc(), sampling.getrsc());
+  }
+
+  DEBUGprint("strShiftProfileSampling done.");
+  return;
+}
@@ -135,7 +135,7 @@ void MergePdf(DROMPA::Global &p, const std::string &StrAllPdf)
 
 void exec_PCSHARP(DROMPA::Global &p)
 {
-  std::string StrAllPdf("");
+  std::vector<const chrsize *> vchr;
   for(auto &chr: p.gt) {
     if (!p.isincludeYM() && (chr.getname() == "Y" || chr.getname() == "M" || chr.getname() == "Mt")) continue;
     if (p.drawregion.getchr() != "" && p.drawregion.getchr() != chr.getname()) continue;
@@ -158,8 +158,14 @@ void exec_PCSHARP(DROMPA::Global &p)
     std::vector<bed> regionBed(p.drawregion.getRegionBedChr(chr.getname()));
     if (p.drawregion.isRegionBed() && !regionBed.size()) continue;
 
+    vchr.emplace_back(&chr);
+  }
+
+  std::string StrAllPdf("");
+  forEachChrArray(p, vchr, [&] (vChrArray &vReadArray) {
+    const chrsize &chr(vReadArray.getchr());
     std::cout << chr.getrefname() << ": " << std::flush;
-    Figure fig(p, chr);
+    Figure fig(p, std::move(vReadArray));
 
     if (p.thre.sigtest) {
       std::cout << "call peak.." << std::flush;
@@ -173,7 +179,7 @@ void exec_PCSHARP(DROMPA::Global &p)
       t2 = clock();
       PrintTime(t1, t2, "MakePdf");
     }
-  }
+  });
 
   if (p.thre.sigtest) printPeak(p);
   if (p.drawparam.isshowpdf()) MergePdf(p, StrAllPdf);
@@ -193,13 +199,18 @@ void exec_GV(DROMPA::Global &p)
 
   p.drawregion.isRegionOff();
 
-  std::string StrAllPdf("");
+  std::vector<const chrsize *> vchr;
   for(auto &chr: p.gt) {
     if(!p.isincludeYM() && (chr.getname() == "Y" || chr.getname() == "M")) continue;
+    vchr.emplace_back(&chr);
+  }
 
-    Figure fig(p, chr);
+  std::string StrAllPdf("");
+  forEachChrArray(p, vchr, [&] (vChrArray &vReadArray) {
+    const chrsize &chr(vReadArray.getchr());
+    Figure fig(p, std::move(vReadArray));
     if (fig.Draw(p)) StrAllPdf += p.getFigFileNameChr(chr.getrefname()) + " ";
-  }
+  });
 
   MergePdf(p, StrAllPdf);
   return;
@@ -220,13 +231,17 @@ void exec_MULTICI(DROMPA::Global &p)
   profile.setOutputFilename(p, "MULTICI");
   profile.printHead(p);
 
+  std::vector<const chrsize *> vchr;
   for(auto &chr: p.gt) {
     if(!p.isincludeYM() && (chr.getname() == "Y" || chr.getname() == "M")) continue;
-    std::cout << "\nchr" << chr.getname() << "..";
-
-    profile.WriteTSV_EachChr(p, chr);
+    vchr.emplace_back(&chr);
   }
 
+  forEachChrArray(p, vchr, [&] (vChrArray &vReadArray) {
+    std::cout << "\nchr" << vReadArray.getchr().getname() << "..";
+    profile.WriteTSV_EachChr(p, vReadArray);
+  });
+
   profile.printNumOfSites(1);
   //  profile.MakeFigure(p);
 
@@ -237,14 +252,17 @@ void exec_GENWIG(DROMPA::Global &p)
 {
   p.genwig_openfilestream();
 
-  for(auto &chr: p.gt) {
+  std::vector<const chrsize *> vchr;
+  for(auto &chr: p.gt) vchr.emplace_back(&chr);
 
+  forEachChrArray(p, vchr, [&] (vChrArray &vReadArray) {
+    const chrsize &chr(vReadArray.getchr());
     std::cout << chr.getrefname() << ": " << std::flush;
-    Figure fig(p, chr);
+    Figure fig(p, std::move(vReadArray));
 
     std::cout << "Generate wigfile.." << std::flush;
     fig.generateWig(chr.getrefname(), chr.getlen());
-  }
+  });
 
   p.genwig_closefilestream();
   printf("done.\n");
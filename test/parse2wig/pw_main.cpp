@@ -7,17 +7,27 @@
 #include <vector>
 #include <fstream>
 #include <algorithm>
+#include <cstdint>
 #include <boost/filesystem.hpp>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
 #include "pw_makefile.hpp"
 #include "version.hpp"
 #include "pw_gv.hpp"
+#include "SharedReference.hpp"
+#include "ReadMpbldata.hpp"
+#include "ResourcePlan.hpp"
+#include "SplitReference.hpp"
 #include "../submodules/SSP/common/BoostOptions.hpp"
 
-void getOpts(Mapfile &p, int32_t argc, char* argv[]);
+void getOpts(MyOpt::Variables &values, int32_t argc, char* argv[]);
 void setOpts(MyOpt::Opts &);
+void setValues(Mapfile &p, const MyOpt::Variables &values, const bool readinput=true);
 void init_dump(const Mapfile &p, const MyOpt::Variables &);
 void output_stats(const Mapfile &p);
-void output_wigstats(const Mapfile &p);
+void output_wigstats(const Mapfile &p, const WigStatsGenome &ws, const std::string &binprefix);
+void exec_parse2wig(Mapfile &p);
+void exec_batch(const MyOpt::Variables &values);
 
 void printVersion()
 {
@@ -30,16 +40,17 @@ void help_global()
   auto helpmsg = R"(
 ===============
 
-Usage: parse2wig+ [option] -i <inputfile> -o <output> --gt <genome_table>)";
+Usage: parse2wig+ [option] -i <inputfile> -o <output> --gt <genome_table>
+       parse2wig+ [option] --batch <manifest> --gt <genome_table>)";
 
   std::cerr << "\nparse2wig v" << VERSION << helpmsg << std::endl;
   return;
 }
 
 template <class T>
-void CalcDepth(T &obj, const int32_t flen)
+void CalcDepth(T &obj, const int32_t flen, const uint64_t lenexcluded=0)
 {
-  uint64_t lenmpbl(obj.getlenmpbl());
+  uint64_t lenmpbl(obj.getlenmpbl() - lenexcluded);
   double d = getratio(obj.getnread_nonred(Strand::BOTH) * flen, lenmpbl);
   obj.setdepth(d);
 }
@@ -47,7 +58,8 @@ void CalcDepth(T &obj, const int32_t flen)
 void DefineFragmentLength(Mapfile &p)
 {
   if (!p.genome.isPaired() && !p.genome.dflen.isnomodel()) {
-    p.genome.strShiftProfile(p.sspst, p.getprefix(), p.isallchr(), p.isverbose());
+    if (p.fastflen.isOn()) p.genome.strShiftProfileSampling(p.sspst, p.fastflen, p.getprefix(), p.isverbose());
+    else p.genome.strShiftProfile(p.sspst, p.getprefix(), p.isallchr(), p.isverbose());
   }
   for (auto &x: p.genome.chr) {
 //    std::cout << x.getname() << "\t" << p.genome.dflen.getflen() << std::endl;
@@ -58,9 +70,23 @@ void DefineFragmentLength(Mapfile &p)
 
 int main(int32_t argc, char* argv[])
 {
-  Mapfile p;
-  getOpts(p, argc, argv);
+  MyOpt::Variables values;
+  getOpts(values, argc, argv);
+
+  if (values.count("batch")) {
+    exec_batch(values);
+  } else {
+    Mapfile p;
+    setValues(p, values);
+    if (values.count("plan")) ResourcePlan(p, MyOpt::getVal<std::string>(values, "input")).print();
+    else exec_parse2wig(p);
+  }
+
+  return 0;
+}
 
+void exec_parse2wig(Mapfile &p)
+{
   p.genome.initannoChr();
 
   clock_t t1,t2;
@@ -68,19 +94,25 @@ int main(int32_t argc, char* argv[])
   p.genome.read_mapfile();
   t2 = clock();
   PrintTime(t1, t2, "read_mapfile");
+  SplitReference::removeInput(p.getprefix());
+
+  if (p.blacklist.isOn()) p.blacklist.filter(p.genome);
 
   t1 = clock();
-  p.complexity.checkRedundantReads(p.genome);
+  p.redundant.checkRedundantReads(p.genome);
   t2 = clock();
   PrintTime(t1, t2, "checkRedundantReads");
 
+  if (p.downsampling.isOn()) p.downsampling.downsample(p.genome, p.spikein);
+  if (p.spikein.isOn()) p.spikein.separate(p.genome);
+
   t1 = clock();
   DefineFragmentLength(p);
   t2 = clock();
   PrintTime(t1, t2, "ShiftProfile");
 
   for (auto &x: p.genome.chr) CalcDepth(x, p.genome.dflen.getflen());
-  CalcDepth(p.genome, p.genome.dflen.getflen());
+  CalcDepth(p.genome, p.genome.dflen.getflen(), p.spikein.getlenmpbl(p.genome));
 
   p.setFRiP();
 
@@ -96,32 +128,203 @@ int main(int32_t argc, char* argv[])
   t2 = clock();
   std::cout << "generate_wigfile: " << static_cast<double>(t2 - t1) / CLOCKS_PER_SEC << "sec.\n";
 
-  /*  t1 = clock();
-  p.wsGenome.estimateZINB(p.getIdLongestChr());
-  t2 = clock();
-  std::cout << "estimateZINB: " << static_cast<double>(t2 - t1) / CLOCKS_PER_SEC << "sec.\n";*/
+  if (p.regioncount.isOn()) p.regioncount.output(p);
 
   // p.wsGenome.printPeak(p.getbinprefix());
 
   if (p.isverbose()) {
-    output_wigstats(p);
+    // the ZINB parameters are only written to the wig stats file
+    t1 = clock();
+    p.wsGenome.estimateZINB(p.genome.vsepchr.size());
+    t2 = clock();
+    PrintTime(t1, t2, "estimateZINB");
+
+    output_wigstats(p, p.wsGenome, p.getbinprefix());
+
+    // the same statistics of each partition wig
+    for (size_t i=0; i<p.partition.size(); ++i) {
+      auto &ws = p.partition.getWigStats(i);
+      ws.estimateZINB(p.genome.vsepchr.size());
+      output_wigstats(p, ws, p.getprefix() + "." + p.partition.getlabel(i) + "." + std::to_string(p.wsGenome.getbinsize()));
+    }
     p.genome.dflen.outputDistFile(p.getprefix(), p.genome.getnread(Strand::BOTH));
   }
   output_stats(p);
 
-  return 0;
+  return;
+}
+
+namespace {
+  class BatchSample {
+  public:
+    std::string input;
+    std::string output;
+    BatchSample(const std::string &i, const std::string &o): input(i), output(o) {}
+  };
+
+  std::vector<BatchSample> readManifest(const std::string &filename)
+  {
+    std::ifstream in(filename);
+    if (!in) PRINTERR_AND_EXIT("cannot open " << filename);
+
+    std::vector<BatchSample> vsample;
+    std::string lineStr;
+    while (!in.eof()) {
+      getline(in, lineStr);
+      if (lineStr.empty() || lineStr[0] == '#') continue;
+      std::vector<std::string> v;
+      ParseLine(v, lineStr, '\t');
+      if (v.size() < 2) PRINTERR_AND_EXIT("invalid line in " << filename << " (<inputfile>\t<output> required): " << lineStr);
+      vsample.emplace_back(v[0], v[1]);
+    }
+    if (vsample.empty()) PRINTERR_AND_EXIT("no sample in " << filename);
+
+    return vsample;
+  }
+
+  template <class T>
+  void setVal(MyOpt::Variables &values, const std::string &name, const T &val)
+  {
+    values.erase(name);
+    values.insert(std::make_pair(name, boost::program_options::variable_value(val, false)));
+  }
+
+  /* "-i -": reads SAM/BAM from a pipe. htslib detects the format from the stream itself.
+     The input is read only once; the later stages use the reads kept in memory. */
+  void setStdinInput(MyOpt::Variables &values)
+  {
+    setVal(values, "input", std::string("/dev/stdin"));
+    if (!values.count("ftype")) setVal(values, "ftype", std::string("BAM"));
+  }
+
+  class MemoryBudget {
+    uint64_t limit;
+    uint64_t used;
+    int32_t nrunning;
+    boost::mutex mtx;
+    boost::condition_variable cond;
+
+  public:
+    explicit MemoryBudget(const uint64_t l): limit(l), used(0), nrunning(0) {}
+
+    void reserve(const uint64_t size) {
+      boost::mutex::scoped_lock lock(mtx);
+      // the reference data shared among the samples are also counted.
+      // a sample exceeding the budget is processed alone
+      while (limit && nrunning && used + SharedReference::getMemoryUsage() + size > limit) cond.wait(lock);
+      used += size;
+      ++nrunning;
+    }
+    void release(const uint64_t size) {
+      {
+        boost::mutex::scoped_lock lock(mtx);
+        used -= size;
+        --nrunning;
+      }
+      cond.notify_all();
+    }
+  };
+
+  void runBatchSamples(const MyOpt::Variables &values,
+                       const std::vector<BatchSample> &vsample,
+                       size_t &next, boost::mutex &mtx,
+                       MemoryBudget &budget, const int32_t nthreads)
+  {
+    while (1) {
+      size_t i;
+      {
+        boost::mutex::scoped_lock lock(mtx);
+        if (next >= vsample.size()) break;
+        i = next++;
+      }
+
+      MyOpt::Variables v(values);
+      setVal(v, "input", vsample[i].input);
+      setVal(v, "output", vsample[i].output);
+      setVal(v, "threads", nthreads);
+
+      Mapfile p;
+      setValues(p, v);
+
+      uint64_t size(ResourcePlan(p, vsample[i].input).getPeakMemory());
+      budget.reserve(size);
+      exec_parse2wig(p);
+      budget.release(size);
+    }
+  }
+}
+
+void exec_batch(const MyOpt::Variables &values)
+{
+  auto vsample = readManifest(MyOpt::getVal<std::string>(values, "batch"));
+  for (auto &x: vsample) {
+    std::vector<std::string> v;
+    ParseLine(v, x.input, ',');
+    for (auto &file: v) {
+      if (file == "-") PRINTERR_AND_EXIT("stdin input (-) cannot be used in --batch mode.");
+      isFile(file);
+    }
+  }
+
+  if (values.count("plan")) {
+    for (auto &x: vsample) {
+      MyOpt::Variables v(values);
+      setVal(v, "input", x.input);
+      setVal(v, "output", x.output);
+      Mapfile p;
+      setValues(p, v);
+      ResourcePlan(p, x.input).print();
+    }
+    return;
+  }
+
+  int32_t nthreads(MyOpt::getVal<int32_t>(values, "threads"));
+  int32_t nworker(std::min(static_cast<size_t>(nthreads), vsample.size()));
+  int32_t nthreads_per_sample(std::max(1, nthreads / nworker));
+  uint64_t limit(MyOpt::getVal<double>(values, "batch_mem") * 1000 * NUM_1M);
+
+  std::cout << boost::format("Batch mode: %1% samples, %2% samples in parallel with %3% threads each\n")
+    % vsample.size() % nworker % nthreads_per_sample;
+
+  // missing mappability wig files are generated before the samples run in parallel
+  {
+    MyOpt::Variables v(values);
+    setVal(v, "input", vsample[0].input);
+    setVal(v, "output", vsample[0].output);
+    Mapfile p;
+    setValues(p, v, false);
+    for (auto &chr: p.genome.chr) {
+      prepareMpblWigData(p.getMpblBinaryDir(), "chr" + chr.getname(), chr.getlen(), p.wsGenome.getbinsize());
+    }
+  }
+
+  SharedReference::activate();
+
+  MemoryBudget budget(limit);
+  size_t next(0);
+  boost::mutex mtx;
+  boost::thread_group agroup;
+  for (int32_t i=0; i<nworker; ++i) {
+    agroup.create_thread(boost::bind(runBatchSamples, boost::cref(values), boost::cref(vsample),
+                                     boost::ref(next), boost::ref(mtx), boost::ref(budget), nthreads_per_sample));
+  }
+  agroup.join_all();
+
+  std::cout << boost::format("Batch mode done. Shared reference data: %1$.1f MB\n")
+    % (SharedReference::getMemoryUsage() / static_cast<double>(NUM_1M));
+  SharedReference::release();
+  return;
 }
 
-void getOpts(Mapfile &p, int32_t argc, char* argv[])
+void getOpts(MyOpt::Variables &values, int32_t argc, char* argv[])
 {
   DEBUGprint_FUNCStart();
 
   MyOpt::Opts allopts("Options");
+  Mapfile p;
   p.setOpts(allopts);
   setOpts(allopts);
 
-  MyOpt::Variables values;
-
   DEBUGprint("getOpts...");
 
   try {
@@ -140,14 +343,40 @@ void getOpts(Mapfile &p, int32_t argc, char* argv[])
     help_global();
     PRINTERR_AND_EXIT("\n" << allopts);
   }
-  std::vector<std::string> opts = {"input", "output", "gt"};
+  std::vector<std::string> opts = {"gt"};
+  if (!values.count("batch")) {
+    opts.emplace_back("input");
+    opts.emplace_back("output");
+  }
   for (auto x: opts) {
     if (!values.count(x)) PRINTERR_AND_EXIT("specify --" << x << " option.");
   }
 
+  if (values.count("input") && MyOpt::getVal<std::string>(values, "input") == "-") {
+    if (values.count("batch")) PRINTERR_AND_EXIT("stdin input (-i -) cannot be used with --batch.");
+    if (values.count("plan")) PRINTERR_AND_EXIT("stdin input (-i -) cannot be used with --plan.");
+    setStdinInput(values);
+  }
+
   try {
     notify(values);
-    p.setValues(values);
+  } catch(const boost::bad_any_cast& e) {
+    PRINTERR_AND_EXIT(e.what());
+  }
+
+  DEBUGprint_FUNCend();
+  return;
+}
+
+/* readinput: false when the reads are not processed (the input is not converted for long chromosomes) */
+void setValues(Mapfile &p, const MyOpt::Variables &values, const bool readinput)
+{
+  try {
+    // chromosomes of 2^31 bp or longer are read as parts
+    MyOpt::Variables v(values);
+    SplitReference::setGenomeTable(v);
+    if (readinput && !values.count("plan")) SplitReference::convertInput(v);
+    p.setValues(v);
 
     boost::filesystem::path dir(MyOpt::getVal<std::string>(values, "odir"));
     boost::filesystem::create_directory(dir);
@@ -156,8 +385,6 @@ void getOpts(Mapfile &p, int32_t argc, char* argv[])
   } catch(const boost::bad_any_cast& e) {
     PRINTERR_AND_EXIT(e.what());
   }
-
-  DEBUGprint_FUNCend();
   return;
 }
 
@@ -166,6 +393,17 @@ void setOpts(MyOpt::Opts &allopts)
   MyOpt::setOptIO(allopts, "parse2wigdir+");
   MyOpt::setOptPair(allopts);
   MyOpt::setOptOther(allopts);
+
+  MyOpt::Opts opt("Batch mode", 100);
+  opt.add_options()
+    ("batch", boost::program_options::value<std::string>(),
+     "Manifest file of samples (<inputfile>\t<output> per line) to be processed in a single run.\nMappability and genome sequence data are loaded once and shared among the samples.\nSamples are processed in parallel with the threads specified by -p")
+    ("batch_mem",
+     boost::program_options::value<double>()->default_value(0)->notifier(std::bind(&MyOpt::over<double>, std::placeholders::_1, 0, "--batch_mem")),
+     "(for --batch) Memory budget (GB) for samples processed in parallel (0: no limit)")
+    ("plan", "Report the expected peak memory and runtime of each stage from the BAM index and the genome table, without processing the reads")
+    ;
+  allopts.add(opt);
   return;
 }
 
@@ -234,9 +472,12 @@ void output_stats(const Mapfile &p)
 
   out << "parse2wig+ version " << VERSION << std::endl;
   out << "Input file: \"" << p.genome.getInputfile() << "\"" << std::endl;
-  out << "Redundancy threshold: >" << p.complexity.getThreshold() << std::endl;
+  out << "Redundancy threshold: >" << p.redundant.getThreshold() << std::endl;
 
-  p.complexity.print(out);
+  p.blacklist.print(out, p.genome.getnread(Strand::BOTH));
+  p.redundant.print(out);
+  p.downsampling.print(out);
+  p.spikein.print(out);
   p.genome.dflen.printreadlen(out);
   p.genome.dflen.printFlen(out);
   if (p.gc.isGcNormOn()) out << "GC summit: " << p.getmaxGC() << std::endl;
@@ -265,6 +506,7 @@ void output_stats(const Mapfile &p)
   out << std::endl;
 
   for(size_t i=0; i<p.getnchr(); ++i) {
+    if (p.spikein.isSpikein(i)) continue;
     print_SeqStats(out, p.genome.getannochr(i), p.gcov.chr[i], p);
     out << std::endl;
   }
@@ -274,27 +516,51 @@ void output_stats(const Mapfile &p)
   return;
 }
 
-void output_wigstats(const Mapfile &p)
+void output_wigstats(const Mapfile &p, const WigStatsGenome &ws, const std::string &binprefix)
 {
-  std::string filename = p.getbinprefix() + ".ReadCountDist.tsv";
+  std::string filename = binprefix + ".ReadCountDist.tsv";
   std::ofstream out(filename);
 
   std::cout << "generate " << filename << ".." << std::flush;
 
+  // spike-in chromosomes are excluded from the statistics
   out << "\tGenome\t\t";
-  for (auto &x: p.genome.chr) out << x.getname() << "\t\t";
+  for (size_t i=0; i<p.getnchr(); ++i) {
+    if (!p.spikein.isSpikein(i)) out << p.genome.chr[i].getname() << "\t\t";
+  }
   out << std::endl;
   out << "read number\tnum of bins genome\tprop\t";
-  for (size_t i=0; i<p.getnchr(); ++i) out << "num of bins\tprop\t";
+  for (size_t i=0; i<p.getnchr(); ++i) {
+    if (!p.spikein.isSpikein(i)) out << "num of bins\tprop\t";
+  }
   out << std::endl;
 
-  for(int32_t i=0; i<p.wsGenome.getWigDistsize(); ++i) {
+  for(int32_t i=0; i<ws.getWigDistsize(); ++i) {
     out << i << "\t";
-    for (auto &x: p.wsGenome.chr) x.printWigDist(out, i);
+    ws.genome.printWigDist(out, i);
+    for (size_t j=0; j<p.getnchr(); ++j) {
+      if (!p.spikein.isSpikein(j)) ws.chr[j].printWigDist(out, i);
+    }
     out << std::endl;
   }
 
   std::cout << "done." << std::endl;
+
+  // ZINB background model fitted to the read count distribution
+  filename = binprefix + ".ZINBparam.tsv";
+  std::ofstream outzinb(filename);
+  outzinb << "chromosome\tp\tn\tp0" << std::endl;
+  outzinb << "Genome\t";
+  ws.genome.printZINBpar(outzinb);
+  outzinb << std::endl;
+  for (size_t i=0; i<p.getnchr(); ++i) {
+    if (p.spikein.isSpikein(i)) continue;
+    outzinb << p.genome.chr[i].getname() << "\t";
+    ws.chr[i].printZINBpar(outzinb);
+    outzinb << std::endl;
+  }
+  std::cout << "ZINB parameters are output in " << filename << "." << std::endl;
+
   return;
 }
 
@@ -315,14 +581,25 @@ void Mapfile::setValues(const MyOpt::Variables &values)
   verbose = values.count("verbose");
   allchr = true; // values.count("allchr");
 
+  // chromosomes of 2^31 bp or longer are given as parts (SplitReference)
   genome.setValues(values);
   wsGenome.setValues(values, genome.chr);
+  partition.setValues(values, genome.chr.size(), genome.isPaired());
 
   //  for (auto &x: genome.chr) wsGenome.chr.emplace_back(x.getlen(), wsGenome.getbinsize());
 
   rpm.setValues(values);
   complexity.setValues(values);
+  redundant.setValues(values);
+  downsampling.setValues(values);
+  blacklist.setValues(values);
+  spikein.setValues(values, genome.chr);
+  for (size_t i=0; i<genome.chr.size(); ++i) {
+    if (spikein.isSpikein(i)) wsGenome.excludeChr(i);
+  }
+  regioncount.setValues(values);
   sspst.setValues(values);
+  fastflen.setValues(values);
   gc.setValues(values);
 
   samplename = MyOpt::getVal<std::string>(values, "output");
@@ -340,8 +617,8 @@ void AnnotationSeqStatsGenome::setFRiP(const std::vector<bed> &vbed, strandData
   std::vector<BpStatus> array(len, BpStatus::MAPPABLE);
   setPeak_to_MpblBpArray(array, chrname, vbed);
 
-  int32_t n(0);
-  for(size_t i=0; i<=len; ++i) {
+  int64_t n(0);
+  for(size_t i=0; i<len; ++i) {
     if(array[i]==BpStatus::INBED) ++n;
   }
 //  printf("test len %d n %d\n", len, n);
@@ -350,10 +627,10 @@ void AnnotationSeqStatsGenome::setFRiP(const std::vector<bed> &vbed, strandData
   for (auto strand: {Strand::FWD, Strand::REV}) {
     for (auto &x: seq[strand].vRead) {
       if(x.duplicate) continue;
-      int32_t s(std::min(x.F3, x.F5));
-      int32_t e(std::max(x.F3, x.F5));
+      int64_t s(std::max(0, std::min(x.F3, x.F5)));
+      int64_t e(std::min(static_cast<int64_t>(std::max(x.F3, x.F5)), static_cast<int64_t>(len) -1));
 
-      for(int32_t i=s; i<=e; ++i) {
+      for(int64_t i=s; i<=e; ++i) {
 	if(array[i] == BpStatus::INBED) {
 	  x.inpeak = 1;
 	  ++nread_inbed;